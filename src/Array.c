@@ -1,8 +1,14 @@
 #pragma once
 
 #include "raylib.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 /* Allocate memory using the same memory allocator as the `Array` functions. */
 #define Array_mem_alloc MemAlloc
@@ -11,6 +17,311 @@
 /*  Deallocate memory using the same memory allocator as the `Array` functions. */
 #define Array_mem_free MemFree
 
+/*
+ *  If `ARRAY_RAW` is defined before this file is included, `Array_at`, `Array_set`, `Array_swap` and `Array_less`
+ *  are compiled as unchecked, callback-free `static inline` functions so that the same algorithm source
+ *  runs at native speed (used for benchmarks and batch sorting). Without it, every access is bounds checked
+ *  and reported to the observers of the array (used by the visualizer).
+ *  WARNING: In raw mode an out of bounds index is undefined behaviour instead of `ARRAY_ERR`.
+ */
+#ifdef ARRAY_RAW
+#define ARRAY_ACCESS static inline
+#else
+#define ARRAY_ACCESS
+#endif
+
+/*
+ *  Where the items of an `Array` live, chosen per array (see `Array_new_with`); the `Array` struct itself always comes from `Array_mem_alloc`.
+ *  `alloc` returns `size` bytes (or `NULL`), `realloc` resizes memory from `alloc` from `old_size` to `size` bytes keeping its contents
+ *  (or returns `NULL`, leaving it as it was), and `free` releases memory of `size` bytes from either; each takes `state` first.
+ */
+typedef struct Array_Allocator
+{
+    void *(*alloc)(void *state, size_t size);
+    void *(*realloc)(void *state, void *pointer, size_t old_size, size_t size);
+    void (*free)(void *state, void *pointer, size_t size);
+    void *state;
+} Array_Allocator;
+
+static void *_Array_malloc_alloc(void *state, size_t size)
+{
+    return Array_mem_alloc(size);
+}
+
+static void *_Array_malloc_realloc(void *state, void *pointer, size_t old_size, size_t size)
+{
+    return Array_mem_realloc(pointer, size);
+}
+
+static void _Array_malloc_free(void *state, void *pointer, size_t size)
+{
+    Array_mem_free(pointer);
+}
+
+/* The default allocator: `Array_mem_alloc` and co. */
+const Array_Allocator Array_malloc_allocator = {_Array_malloc_alloc, _Array_malloc_realloc, _Array_malloc_free, NULL};
+
+/*
+ *  A bump arena for the items of scratch arrays: allocating moves a pointer forward in one block reserved up front, and all the items
+ *  allocated from it are released at once by `Array_Arena_reset`. Freeing (or growing) the memory allocated last is done in place; freeing anything else
+ *  only gives its memory back at the next reset. Use `&arena->allocator` as the allocator of the arrays.
+ *  Only the items live in the arena: every array still has to be freed with `Array_free` (for its `Array` struct, from `Array_mem_alloc`),
+ *  and before the arena is reset, since freeing its items afterwards could give back memory that was allocated again.
+ */
+typedef struct Array_Arena
+{
+    unsigned char *base;
+    size_t capacity;
+    /** The number of bytes of `base` in use */
+    size_t used;
+    /** The offset of the memory allocated last */
+    size_t last;
+    Array_Allocator allocator;
+} Array_Arena;
+
+/* The alignment of the memory of an `Array_Arena` (a cache line) */
+#define ARRAY_ARENA_ALIGNMENT 64
+
+static void *_Array_arena_alloc(void *state, size_t size)
+{
+    Array_Arena *arena = state;
+    uintptr_t start = ((uintptr_t)(arena->base + arena->used) + ARRAY_ARENA_ALIGNMENT - 1) & ~(uintptr_t)(ARRAY_ARENA_ALIGNMENT - 1);
+    size_t offset = start - (uintptr_t)arena->base;
+    if (offset > arena->capacity || size > arena->capacity - offset)
+        return NULL;
+    arena->last = offset;
+    arena->used = offset + size;
+    return arena->base + offset;
+}
+
+static void *_Array_arena_realloc(void *state, void *pointer, size_t old_size, size_t size)
+{
+    Array_Arena *arena = state;
+    if (pointer == arena->base + arena->last && size <= arena->capacity - arena->last)
+    {
+        arena->used = arena->last + size;
+        return pointer;
+    }
+    void *moved = _Array_arena_alloc(arena, size);
+    if (moved != NULL)
+        memcpy(moved, pointer, old_size < size ? old_size : size);
+    return moved;
+}
+
+static void _Array_arena_free(void *state, void *pointer, size_t size)
+{
+    Array_Arena *arena = state;
+    if (pointer == arena->base + arena->last)
+        arena->used = arena->last;
+}
+
+/** @brief Sets up `arena` with `capacity` bytes, taken from `Array_mem_alloc` */
+void Array_Arena_init(Array_Arena *arena, size_t capacity)
+{
+    arena->base = Array_mem_alloc(capacity);
+    arena->capacity = arena->base != NULL ? capacity : 0;
+    arena->used = 0;
+    arena->last = 0;
+    arena->allocator = (Array_Allocator){_Array_arena_alloc, _Array_arena_realloc, _Array_arena_free, arena};
+}
+
+/** @brief Releases all the items allocated from `arena` at once; the arrays using them must have been freed already */
+void Array_Arena_reset(Array_Arena *arena)
+{
+    arena->used = 0;
+    arena->last = 0;
+}
+
+/** @brief Frees the memory of `arena`; like a reset, only once the arrays using it were freed */
+void Array_Arena_free(Array_Arena *arena)
+{
+    Array_mem_free(arena->base);
+    *arena = (Array_Arena){0};
+}
+
+/* The size of a transparent huge page on x86-64 Linux; memory of `Array_huge_page_allocator` is aligned to it and allocated in multiples of it */
+#define ARRAY_HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+#ifndef _WIN32
+/** @brief Internal function: the size of the mapping holding `size` bytes with `Array_huge_page_allocator` */
+static inline size_t _Array_huge_page_size(size_t size)
+{
+    return ((size > 0 ? size : 1) + ARRAY_HUGE_PAGE_SIZE - 1) & ~(ARRAY_HUGE_PAGE_SIZE - 1);
+}
+
+static void *_Array_huge_page_alloc(void *state, size_t size)
+{
+    size = _Array_huge_page_size(size);
+    // mapped one huge page larger, then trimmed to the first huge page boundary, since only aligned huge pages can be backed by one
+    unsigned char *mapped = mmap(NULL, size + ARRAY_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED)
+        return NULL;
+    size_t head = (ARRAY_HUGE_PAGE_SIZE - (uintptr_t)mapped % ARRAY_HUGE_PAGE_SIZE) % ARRAY_HUGE_PAGE_SIZE;
+    if (head > 0)
+        munmap(mapped, head);
+    munmap(mapped + head + size, ARRAY_HUGE_PAGE_SIZE - head);
+#ifdef MADV_HUGEPAGE
+    madvise(mapped + head, size, MADV_HUGEPAGE);
+#endif
+    return mapped + head;
+}
+
+static void _Array_huge_page_free(void *state, void *pointer, size_t size)
+{
+    munmap(pointer, _Array_huge_page_size(size));
+}
+
+static void *_Array_huge_page_realloc(void *state, void *pointer, size_t old_size, size_t size)
+{
+    if (_Array_huge_page_size(size) == _Array_huge_page_size(old_size))
+        return pointer;
+    void *moved = _Array_huge_page_alloc(state, size);
+    if (moved == NULL)
+        return NULL;
+    memcpy(moved, pointer, old_size < size ? old_size : size);
+    _Array_huge_page_free(state, pointer, old_size);
+    return moved;
+}
+
+/*
+ *  Anonymous `mmap` memory in whole, aligned huge pages, which Linux is asked (`MADV_HUGEPAGE`) to back with 2 MiB pages:
+ *  large arrays then take far fewer TLB entries and page faults. Elsewhere it is still page-aligned `mmap` memory.
+ *  As every allocation takes at least one huge page, it is meant for arrays of several MiB.
+ */
+const Array_Allocator Array_huge_page_allocator = {_Array_huge_page_alloc, _Array_huge_page_realloc, _Array_huge_page_free, NULL};
+
+/*
+ *  Memory mapped from a file (created if needed, and resized to the memory), so that arrays larger than RAM can be sorted
+ *  and the items of an array are left in the file when it is freed. One `Array_File` backs one array at a time;
+ *  set it up with `Array_File_init` and use `&file->allocator` as the allocator of the array.
+ */
+typedef struct Array_File
+{
+    const char *path;
+    /** The descriptor of the file while it backs an array, -1 otherwise */
+    int descriptor;
+    Array_Allocator allocator;
+} Array_File;
+
+static void *_Array_file_map(Array_File *file, size_t size)
+{
+    if (ftruncate(file->descriptor, (off_t)size) != 0)
+        return NULL;
+    void *mapped = mmap(NULL, size > 0 ? size : 1, PROT_READ | PROT_WRITE, MAP_SHARED, file->descriptor, 0);
+    return mapped != MAP_FAILED ? mapped : NULL;
+}
+
+static void *_Array_file_alloc(void *state, size_t size)
+{
+    Array_File *file = state;
+    if (file->descriptor != -1)
+        return NULL;
+    file->descriptor = open(file->path, O_RDWR | O_CREAT, 0644);
+    if (file->descriptor == -1)
+        return NULL;
+    void *mapped = _Array_file_map(file, size);
+    if (mapped == NULL)
+    {
+        close(file->descriptor);
+        file->descriptor = -1;
+    }
+    return mapped;
+}
+
+static void *_Array_file_realloc(void *state, void *pointer, size_t old_size, size_t size)
+{
+    Array_File *file = state;
+    if (size <= old_size)
+    {
+        // shrinking keeps the mapping and only drops its whole pages past `size`; if the file can't be cut to size first, nothing changes
+        if (ftruncate(file->descriptor, (off_t)size) != 0)
+            return NULL;
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t kept = ((size > 0 ? size : 1) + page - 1) / page * page;
+        if (kept < old_size)
+            munmap((unsigned char *)pointer + kept, old_size - kept);
+        return pointer;
+    }
+    // the items are in the file, so the new mapping sees them; the old one is only dropped once that worked
+    void *mapped = _Array_file_map(file, size);
+    if (mapped == NULL)
+        return NULL;
+    munmap(pointer, old_size > 0 ? old_size : 1);
+    return mapped;
+}
+
+static void _Array_file_free(void *state, void *pointer, size_t size)
+{
+    Array_File *file = state;
+    munmap(pointer, size > 0 ? size : 1);
+    close(file->descriptor);
+    file->descriptor = -1;
+}
+
+/** @brief Sets up `file` to back an array with the file at `path`, which must outlive `file` */
+void Array_File_init(Array_File *file, const char *path)
+{
+    file->path = path;
+    file->descriptor = -1;
+    file->allocator = (Array_Allocator){_Array_file_alloc, _Array_file_realloc, _Array_file_free, file};
+}
+#else
+/* Windows has no `mmap`, and large pages there need a privilege that can't be assumed: both backends fall back to `Array_mem_alloc` */
+const Array_Allocator Array_huge_page_allocator = {_Array_malloc_alloc, _Array_malloc_realloc, _Array_malloc_free, NULL};
+
+typedef struct Array_File
+{
+    const char *path;
+    Array_Allocator allocator;
+} Array_File;
+
+/** @brief Sets up `file`; on Windows the array is kept in memory instead, and nothing is written to `path` */
+void Array_File_init(Array_File *file, const char *path)
+{
+    file->path = path;
+    file->allocator = Array_malloc_allocator;
+}
+#endif
+
+struct Array;
+
+/**
+ * @brief A type for an array access callback function pointer.
+ * It takes the `context` of its `Array_Observer`, an `Array` (the array accessed) and a `size_t` (the index of the `Array` that was accessed).
+ */
+typedef void (*Array_CallbackType)(void *, struct Array *, size_t);
+
+/**
+ * @brief A type for a comparison callback function pointer.
+ * It takes the `context` of its `Array_Observer` and an `Array` (the array whose items were compared).
+ */
+typedef void (*Array_CompareCallbackType)(void *, struct Array *);
+
+/**
+ * @brief A type for a range access callback function pointer.
+ * It takes the `context` of its `Array_Observer`, an `Array` (the array accessed), a `size_t` (the first index accessed) and a `size_t` (the number of items accessed).
+ */
+typedef void (*Array_RangeCallbackType)(void *, struct Array *, size_t, size_t);
+
+/*
+ *  Something that watches the accesses of an `Array` (the audio, the bar colors, statistics, a trace recorder...), attached with `Array_observe`.
+ *  `at` is invoked after every `Array_at`, `set` after every `Array_set` and `compare` on every `Array_less`, each with `context`;
+ *  `at_range` and `set_range` are invoked once for all the items read or written by a range operation (`Array_fill`, `Array_rotate`...).
+ *  Any of them may be `NULL`; an observer without `at_range` (or `set_range`) gets an `at` (or `set`) call for each item of the range instead.
+ */
+typedef struct Array_Observer
+{
+    Array_CallbackType at;
+    Array_CallbackType set;
+    Array_CompareCallbackType compare;
+    void *context;
+    Array_RangeCallbackType at_range;
+    Array_RangeCallbackType set_range;
+} Array_Observer;
+
+/* The most observers an `Array` can have at once */
+#define ARRAY_MAX_OBSERVERS 8
+
 /*
  *  Represents an array used in the sorting algorithm visualizer
  */
@@ -18,6 +329,25 @@ typedef struct Array
 {
     unsigned int *_arr;
     size_t len;
+    /** The number of items `_arr` has room for (at least `len`); grown geometrically by `Array_push` and `Array_append` */
+    size_t capacity;
+    /** Where `_arr` comes from */
+    const Array_Allocator *_allocator;
+    /** The number of observers of this array */
+    int _observer_count;
+    /** The observers of this array, in the order they were attached */
+    Array_Observer _observers[ARRAY_MAX_OBSERVERS];
+    /**
+     * Where each kind of access is reported: straight to the only observer that has a callback for it, to a function calling
+     * every observer when several do, or nowhere (`NULL`) when none does, in which case the access costs a single test.
+     * Kept up to date by `Array_observe` and `Array_unobserve`.
+     */
+    Array_CallbackType _at;
+    void *_at_context;
+    Array_CallbackType _set;
+    void *_set_context;
+    Array_CompareCallbackType _compare;
+    void *_compare_context;
 } * Array;
 
 /*
@@ -70,36 +400,155 @@ typedef const struct Algorithm
     const char *name;
 } Algorithm;
 
+/* The capacity an `Array` first grows to when it has none */
+#define ARRAY_MIN_CAPACITY 8
+
+/** @brief Internal function: reports a read of `array` at `index` to all of its observers */
+static void _Array_notify_at(void *context, Array array, size_t index)
+{
+    for (int i = 0; i < array->_observer_count; i++)
+        if (array->_observers[i].at != NULL)
+            array->_observers[i].at(array->_observers[i].context, array, index);
+}
+
+/** @brief Internal function: reports a write to `array` at `index` to all of its observers */
+static void _Array_notify_set(void *context, Array array, size_t index)
+{
+    for (int i = 0; i < array->_observer_count; i++)
+        if (array->_observers[i].set != NULL)
+            array->_observers[i].set(array->_observers[i].context, array, index);
+}
+
+/** @brief Internal function: reports a comparison of items of `array` to all of its observers */
+static void _Array_notify_compare(void *context, Array array)
+{
+    for (int i = 0; i < array->_observer_count; i++)
+        if (array->_observers[i].compare != NULL)
+            array->_observers[i].compare(array->_observers[i].context, array);
+}
+
+#ifndef ARRAY_RAW
+/** @brief Internal function: reports a read of the `count` items of `array` from `index` to all of its observers */
+static void _Array_notify_at_range(Array array, size_t index, size_t count)
+{
+    for (int i = 0; i < array->_observer_count; i++)
+    {
+        const Array_Observer *observer = &array->_observers[i];
+        if (observer->at_range != NULL)
+            observer->at_range(observer->context, array, index, count);
+        else if (observer->at != NULL)
+            for (size_t j = index; j < index + count; j++)
+                observer->at(observer->context, array, j);
+    }
+}
+
+/** @brief Internal function: reports a write to the `count` items of `array` from `index` to all of its observers */
+static void _Array_notify_set_range(Array array, size_t index, size_t count)
+{
+    for (int i = 0; i < array->_observer_count; i++)
+    {
+        const Array_Observer *observer = &array->_observers[i];
+        if (observer->set_range != NULL)
+            observer->set_range(observer->context, array, index, count);
+        else if (observer->set != NULL)
+            for (size_t j = index; j < index + count; j++)
+                observer->set(observer->context, array, j);
+    }
+}
+#endif
+
+/** @brief Internal function: points `_at`, `_set` and `_compare` of `array` to where each kind of access should be reported */
+static void _Array_update_dispatch(Array array)
+{
+    array->_at = NULL;
+    array->_set = NULL;
+    array->_compare = NULL;
+    for (int i = 0; i < array->_observer_count; i++)
+    {
+        const Array_Observer *observer = &array->_observers[i];
+        if (observer->at != NULL)
+        {
+            array->_at = array->_at == NULL ? observer->at : _Array_notify_at;
+            array->_at_context = observer->context;
+        }
+        if (observer->set != NULL)
+        {
+            array->_set = array->_set == NULL ? observer->set : _Array_notify_set;
+            array->_set_context = observer->context;
+        }
+        if (observer->compare != NULL)
+        {
+            array->_compare = array->_compare == NULL ? observer->compare : _Array_notify_compare;
+            array->_compare_context = observer->context;
+        }
+    }
+}
+
 /**
- * @brief A type for an array access callback function pointer.
- * It takes an `Array` (the array accessed) and a `size_t` (the index of the `Array` that was accessed).
+ * @brief Attaches `observer` to `array`, after the observers it already has.
+ * Observers are called in the thread accessing the array; attach and detach them from that thread, or before sharing the array.
+ *
+ * @return `ARRAY_ERR` (without attaching it) if `array` already has `ARRAY_MAX_OBSERVERS` observers; `ARRAY_OK` otherwise
  */
-typedef void (*Array_CallbackType)(Array, size_t);
-/** @brief Internal value */
-static void _Array_default_callback(Array array, size_t index) {}
-/** @brief Internal value */
-static Array_CallbackType _Array_at_callback = _Array_default_callback;
-/** @brief Internal value */
-static Array_CallbackType _Array_set_callback = _Array_default_callback;
+Array_ResultCondition Array_observe(Array array, Array_Observer observer)
+{
+    if (array->_observer_count == ARRAY_MAX_OBSERVERS)
+        return ARRAY_ERR;
+    array->_observers[array->_observer_count++] = observer;
+    _Array_update_dispatch(array);
+    return ARRAY_OK;
+}
 
 /**
- * @brief Sets `_Array_at_callback`, the callback invoked every time Array_set is.
+ * @brief Detaches the observers of `array` whose context is `context`, keeping the others in order
  *
- * @param callback What to set `_Array_at_callback` to
+ * @return `ARRAY_ERR` if there were none; `ARRAY_OK` otherwise
  */
-void Array_set_at_callback(Array_CallbackType callback)
+Array_ResultCondition Array_unobserve(Array array, void *context)
 {
-    _Array_at_callback = callback;
+    int kept = 0;
+    for (int i = 0; i < array->_observer_count; i++)
+        if (array->_observers[i].context != context)
+            array->_observers[kept++] = array->_observers[i];
+    bool found = kept != array->_observer_count;
+    array->_observer_count = kept;
+    _Array_update_dispatch(array);
+    return found ? ARRAY_OK : ARRAY_ERR;
 }
 
 /**
- * @brief Sets `_Array_at_callback`, the callback invoked every time Array_set is.
+ * @brief Internal function: creates a new `Array` of length `len` without observers, whose items (from `allocator`) are left for the caller to initialize
+ * @return `NULL` if `allocator` has no room for the items
+ */
+static Array _Array_new_uninitialized(size_t len, const Array_Allocator *allocator)
+{
+    unsigned int *items = allocator->alloc(allocator->state, len * sizeof(unsigned int));
+    if (items == NULL && len > 0)
+        return NULL;
+    Array returned = Array_mem_alloc(sizeof(struct Array));
+    returned->_arr = items;
+    returned->len = len;
+    returned->capacity = len;
+    returned->_allocator = allocator;
+    returned->_observer_count = 0;
+    _Array_update_dispatch(returned);
+    return returned;
+}
+
+/**
+ * @brief Creates a new `Array` of length `len` whose items are all initalized to zero, and kept in memory from `allocator`
  *
- * @param callback What to set `_Array_at_callback` to
+ * @param len The length of the `Array` to create
+ * @param allocator Where the items live, such as `&Array_huge_page_allocator` for a very large array or the allocator of an `Array_Arena` for a scratch array;
+ * it must outlive the `Array`
+ * @return `NULL` if `allocator` has no room for the items
  */
-void Array_set_set_callback(Array_CallbackType callback)
+Array Array_new_with(size_t len, const Array_Allocator *allocator)
 {
-    _Array_set_callback = callback;
+    Array returned = _Array_new_uninitialized(len, allocator);
+    if (returned != NULL)
+        memset(returned->_arr, 0, sizeof(unsigned int) * len);
+    return returned;
 }
 
 /**
@@ -109,11 +558,7 @@ void Array_set_set_callback(Array_CallbackType callback)
  */
 Array Array_new(size_t len)
 {
-    Array returned = Array_mem_alloc(sizeof(struct Array));
-    returned->len = len;
-    returned->_arr = Array_mem_alloc(len * sizeof(unsigned int));
-    memset(returned->_arr, 0, sizeof(unsigned int) * len);
-    return returned;
+    return Array_new_with(len, &Array_malloc_allocator);
 }
 
 /**
@@ -124,7 +569,7 @@ Array Array_new(size_t len)
  */
 void Array_free(Array array)
 {
-    Array_mem_free(array->_arr);
+    array->_allocator->free(array->_allocator->state, array->_arr, array->capacity * sizeof(unsigned int));
     Array_mem_free(array);
 }
 
@@ -134,18 +579,22 @@ void Array_free(Array array)
  * @param array The `Array` to be indexed into
  * @param index The index to index into the `Array`
  * @return An `Array_Result` struct containing whether the index was successful, and if successful, the result of the index
- * @note If it is defined, invokes `_Array_at_callback` with the `Array` indexed into and the index it was indexed to.
- * `_Array_at_callback` is of type `void(Array, size_t)`.
+ * @note Invokes the `at` callback of every observer of `array` with the `Array` indexed into and the index it was indexed to.
  * @see Array_Result
- * @see Array_set_at_callback
+ * @see Array_observe
  */
-Array_Result Array_at(Array array, size_t index)
+ARRAY_ACCESS Array_Result Array_at(Array array, size_t index)
 {
+#ifdef ARRAY_RAW
+    return (Array_Result){ARRAY_OK, array->_arr[index]};
+#else
     if (index >= array->len)
         return (Array_Result){ARRAY_ERR};
     unsigned int returned = array->_arr[index];
-    _Array_at_callback(array, index);
+    if (array->_at != NULL)
+        array->_at(array->_at_context, array, index);
     return (Array_Result){ARRAY_OK, returned};
+#endif
 }
 
 /**
@@ -155,58 +604,475 @@ Array_Result Array_at(Array array, size_t index)
  * @param index The index of the `Array` to modify
  * @param value The value to replace the current value at the specified index
  * @return `ARRAY_ERR` if `index` is past the end of `array`; `ARRAY_OK` otherwise
- * @note If it is defined, invokes `_Array_set_callback` with the `Array` indexed into and the index it was indexed to.
- * `_Array_set_callback` is of type `void(Array, size_t)`.
- * @see Array_set_set_callback
+ * @note Invokes the `set` callback of every observer of `array` with the `Array` indexed into and the index it was indexed to.
+ * @see Array_observe
  */
-Array_ResultCondition Array_set(Array array, size_t index, unsigned int value)
+ARRAY_ACCESS Array_ResultCondition Array_set(Array array, size_t index, unsigned int value)
 {
+#ifdef ARRAY_RAW
+    array->_arr[index] = value;
+#else
     if (index >= array->len)
         return ARRAY_ERR;
     array->_arr[index] = value;
-    _Array_set_callback(array, index);
+    if (array->_set != NULL)
+        array->_set(array->_set_context, array, index);
+#endif
     return ARRAY_OK;
 }
 
 /**
- * @brief Creates a new `Array` of length `len` with items beginning at 0 and increasing by 1 for each item
+ * @brief Compares two values read from an `Array`.
+ * Sorting algorithms should compare items through this function so that comparisons can be counted.
  *
- * @param len The length of the `Array` to create
+ * @param array The `Array` the values were read from
+ * @param value1 The first value to compare
+ * @param value2 The second value to compare
+ * @return Whether `value1` is less than `value2`
+ * @note Invokes the `compare` callback of every observer of `array` with `array`.
+ * @see Array_observe
  */
-Array Array_new_init(size_t len)
+ARRAY_ACCESS bool Array_less(Array array, unsigned int value1, unsigned int value2)
+{
+#ifndef ARRAY_RAW
+    if (array->_compare != NULL)
+        array->_compare(array->_compare_context, array);
+#endif
+    return value1 < value2;
+}
+
+/*
+ *  Range operations: each works on `count` consecutive items straight in `_arr`, `ARRAY_LANES` items at a time or through `memcpy`/`memmove`,
+ *  checks its bounds once, and reports one range event to the observers instead of one event per item.
+ *  They return `ARRAY_ERR` without touching the array if a range doesn't fit in it.
+ */
+
+/* The range operations work on `ARRAY_LANES` consecutive items at a time */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ARRAY_LANES 8
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ARRAY_LANES 4
+#else
+#define ARRAY_LANES 1
+#endif
+
+/* The largest part of a range (in items) that `Array_rotate` moves through a buffer on the stack instead of rotating by reversals */
+#define ARRAY_ROTATE_BUFFER_ITEMS 256
+
+/** @brief Internal function: whether the `count` items from `index` are all in `array` */
+static inline bool _Array_range_fits(Array array, size_t index, size_t count)
 {
-    Array returned = Array_new(len);
-    for (size_t i = 0; i < len; i++)
-        if (Array_set(returned, i, i) == ARRAY_ERR)
+    return count <= array->len && index <= array->len - count;
+}
+
+/** @brief Internal function: sets `count` items to `value` */
+static void _Array_fill_items(unsigned int *items, size_t count, unsigned int value)
+{
+    size_t i = 0;
+#if ARRAY_LANES == 8
+    const __m256i values = _mm256_set1_epi32((int)value);
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_si256((__m256i *)(items + i), values);
+#elif ARRAY_LANES == 4
+    const __m128i values = _mm_set1_epi32((int)value);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128((__m128i *)(items + i), values);
+#endif
+    for (; i < count; i++)
+        items[i] = value;
+}
+
+/** @brief Internal function: sets `count` items to `first_value`, `first_value + 1`... */
+static void _Array_iota_items(unsigned int *items, size_t count, unsigned int first_value)
+{
+    size_t i = 0;
+#if ARRAY_LANES == 8
+    __m256i values = _mm256_add_epi32(_mm256_set1_epi32((int)first_value), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i values_step = _mm256_set1_epi32(8);
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_si256((__m256i *)(items + i), values);
+        values = _mm256_add_epi32(values, values_step);
+    }
+#elif ARRAY_LANES == 4
+    __m128i values = _mm_add_epi32(_mm_set1_epi32((int)first_value), _mm_setr_epi32(0, 1, 2, 3));
+    const __m128i values_step = _mm_set1_epi32(4);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_si128((__m128i *)(items + i), values);
+        values = _mm_add_epi32(values, values_step);
+    }
+#endif
+    for (; i < count; i++)
+        items[i] = first_value + (unsigned int)i;
+}
+
+/** @brief Internal function: swaps `count` items of `block1` with those of `block2`, which may not overlap */
+static void _Array_swap_items(unsigned int *block1, unsigned int *block2, size_t count)
+{
+    size_t i = 0;
+#if ARRAY_LANES == 8
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i items1 = _mm256_loadu_si256((const __m256i *)(block1 + i));
+        _mm256_storeu_si256((__m256i *)(block1 + i), _mm256_loadu_si256((const __m256i *)(block2 + i)));
+        _mm256_storeu_si256((__m256i *)(block2 + i), items1);
+    }
+#elif ARRAY_LANES == 4
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i items1 = _mm_loadu_si128((const __m128i *)(block1 + i));
+        _mm_storeu_si128((__m128i *)(block1 + i), _mm_loadu_si128((const __m128i *)(block2 + i)));
+        _mm_storeu_si128((__m128i *)(block2 + i), items1);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        unsigned int item = block1[i];
+        block1[i] = block2[i];
+        block2[i] = item;
+    }
+}
+
+/** @brief Internal function: reverses the order of `count` items */
+static void _Array_reverse_items(unsigned int *items, size_t count)
+{
+    size_t i = 0;
+    // whole chunks from both ends are swapped reversed, until they would meet
+#if ARRAY_LANES == 8
+    const __m256i reversed = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    for (; 2 * (i + 8) <= count; i += 8)
+    {
+        unsigned int *last = items + count - i - 8;
+        __m256i first_items = _mm256_loadu_si256((const __m256i *)(items + i));
+        __m256i last_items = _mm256_loadu_si256((const __m256i *)last);
+        _mm256_storeu_si256((__m256i *)(items + i), _mm256_permutevar8x32_epi32(last_items, reversed));
+        _mm256_storeu_si256((__m256i *)last, _mm256_permutevar8x32_epi32(first_items, reversed));
+    }
+#elif ARRAY_LANES == 4
+    for (; 2 * (i + 4) <= count; i += 4)
+    {
+        unsigned int *last = items + count - i - 4;
+        __m128i first_items = _mm_loadu_si128((const __m128i *)(items + i));
+        __m128i last_items = _mm_loadu_si128((const __m128i *)last);
+        _mm_storeu_si128((__m128i *)(items + i), _mm_shuffle_epi32(last_items, _MM_SHUFFLE(0, 1, 2, 3)));
+        _mm_storeu_si128((__m128i *)last, _mm_shuffle_epi32(first_items, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+#endif
+    for (; i < count / 2; i++)
+    {
+        unsigned int item = items[i];
+        items[i] = items[count - 1 - i];
+        items[count - 1 - i] = item;
+    }
+}
+
+/**
+ * @brief Copies `count` items of `source` from `source_index` to `destination` from `destination_index`
+ *
+ * @param destination The `Array` to copy the items to
+ * @param destination_index The index of the first item to overwrite
+ * @param source The `Array` to copy the items from; it may be `destination`, with overlapping ranges
+ * @param source_index The index of the first item to copy
+ * @param count The number of items to copy
+ * @return `ARRAY_ERR` if either range doesn't fit in its array; `ARRAY_OK` otherwise
+ * @note Reports one read of the range of `source`, then one write of the range of `destination`, to their observers.
+ */
+Array_ResultCondition Array_copy_range(Array destination, size_t destination_index, Array source, size_t source_index, size_t count)
+{
+    if (!_Array_range_fits(destination, destination_index, count) || !_Array_range_fits(source, source_index, count))
+        return ARRAY_ERR;
+    if (destination == source)
+        memmove(destination->_arr + destination_index, source->_arr + source_index, count * sizeof(unsigned int));
+    else
+        memcpy(destination->_arr + destination_index, source->_arr + source_index, count * sizeof(unsigned int));
+#ifndef ARRAY_RAW
+    _Array_notify_at_range(source, source_index, count);
+    _Array_notify_set_range(destination, destination_index, count);
+#endif
+    return ARRAY_OK;
+}
+
+/**
+ * @brief Moves `count` items of `array` from `from` to `to`, the ranges possibly overlapping; the items left behind keep their values
+ *
+ * @return `ARRAY_ERR` if either range doesn't fit in `array`; `ARRAY_OK` otherwise
+ * @note Reports one write of the destination range to the observers of `array`.
+ */
+Array_ResultCondition Array_move_range(Array array, size_t to, size_t from, size_t count)
+{
+    if (!_Array_range_fits(array, to, count) || !_Array_range_fits(array, from, count))
+        return ARRAY_ERR;
+    memmove(array->_arr + to, array->_arr + from, count * sizeof(unsigned int));
+#ifndef ARRAY_RAW
+    _Array_notify_set_range(array, to, count);
+#endif
+    return ARRAY_OK;
+}
+
+/**
+ * @brief Sets the `count` items of `array` from `index` to `value`
+ *
+ * @return `ARRAY_ERR` if the range doesn't fit in `array`; `ARRAY_OK` otherwise
+ * @note Reports one write of the range to the observers of `array`.
+ */
+Array_ResultCondition Array_fill(Array array, size_t index, size_t count, unsigned int value)
+{
+    if (!_Array_range_fits(array, index, count))
+        return ARRAY_ERR;
+    _Array_fill_items(array->_arr + index, count, value);
+#ifndef ARRAY_RAW
+    _Array_notify_set_range(array, index, count);
+#endif
+    return ARRAY_OK;
+}
+
+/**
+ * @brief Sets the `count` items of `array` from `index` to `first_value`, `first_value + 1`, `first_value + 2`...
+ *
+ * @return `ARRAY_ERR` if the range doesn't fit in `array`; `ARRAY_OK` otherwise
+ * @note Reports one write of the range to the observers of `array`.
+ */
+Array_ResultCondition Array_iota(Array array, size_t index, size_t count, unsigned int first_value)
+{
+    if (!_Array_range_fits(array, index, count))
+        return ARRAY_ERR;
+    _Array_iota_items(array->_arr + index, count, first_value);
+#ifndef ARRAY_RAW
+    _Array_notify_set_range(array, index, count);
+#endif
+    return ARRAY_OK;
+}
+
+/**
+ * @brief Reverses the order of the `count` items of `array` from `index`
+ *
+ * @return `ARRAY_ERR` if the range doesn't fit in `array`; `ARRAY_OK` otherwise
+ * @note Reports one write of the range to the observers of `array`.
+ */
+Array_ResultCondition Array_reverse_range(Array array, size_t index, size_t count)
+{
+    if (!_Array_range_fits(array, index, count))
+        return ARRAY_ERR;
+    _Array_reverse_items(array->_arr + index, count);
+#ifndef ARRAY_RAW
+    _Array_notify_set_range(array, index, count);
+#endif
+    return ARRAY_OK;
+}
+
+/**
+ * @brief Swaps the `count` items of `array` from `index1` with the `count` items from `index2`; the two blocks may not overlap
+ *
+ * @return `ARRAY_ERR` if either block doesn't fit in `array` or they overlap; `ARRAY_OK` otherwise
+ * @note Reports one write of each block to the observers of `array`.
+ */
+Array_ResultCondition Array_block_swap(Array array, size_t index1, size_t index2, size_t count)
+{
+    if (!_Array_range_fits(array, index1, count) || !_Array_range_fits(array, index2, count) ||
+        (index1 < index2 ? index2 - index1 : index1 - index2) < count)
+        return ARRAY_ERR;
+    _Array_swap_items(array->_arr + index1, array->_arr + index2, count);
+#ifndef ARRAY_RAW
+    _Array_notify_set_range(array, index1, count);
+    _Array_notify_set_range(array, index2, count);
+#endif
+    return ARRAY_OK;
+}
+
+/**
+ * @brief Rotates the `count` items of `array` from `index` left by `shift` places: the item at `index + shift` ends up at `index`,
+ * and the first `shift` items end up at the end of the range
+ *
+ * @return `ARRAY_ERR` if the range doesn't fit in `array` or `shift` is greater than `count`; `ARRAY_OK` otherwise
+ * @note Reports one write of the range to the observers of `array`.
+ */
+Array_ResultCondition Array_rotate(Array array, size_t index, size_t count, size_t shift)
+{
+    if (!_Array_range_fits(array, index, count) || shift > count)
+        return ARRAY_ERR;
+    unsigned int *items = array->_arr + index;
+    size_t rest = count - shift;
+    if (shift <= ARRAY_ROTATE_BUFFER_ITEMS || rest <= ARRAY_ROTATE_BUFFER_ITEMS)
+    {
+        // the smaller part waits in the buffer while the larger one slides over
+        unsigned int buffer[ARRAY_ROTATE_BUFFER_ITEMS];
+        if (shift <= rest)
         {
-            Array_mem_free(returned);
-            return NULL;
+            memcpy(buffer, items, shift * sizeof(unsigned int));
+            memmove(items, items + shift, rest * sizeof(unsigned int));
+            memcpy(items + rest, buffer, shift * sizeof(unsigned int));
         }
+        else
+        {
+            memcpy(buffer, items + shift, rest * sizeof(unsigned int));
+            memmove(items + rest, items, shift * sizeof(unsigned int));
+            memcpy(items, buffer, rest * sizeof(unsigned int));
+        }
+    }
+    else
+    {
+        _Array_reverse_items(items, shift);
+        _Array_reverse_items(items + shift, rest);
+        _Array_reverse_items(items, count);
+    }
+#ifndef ARRAY_RAW
+    _Array_notify_set_range(array, index, count);
+#endif
+    return ARRAY_OK;
+}
+
+/**
+ * @brief Creates a new `Array` of length `len` (whose items are all initalized to zero, in memory from `allocator`) for an algorithm
+ * to use as auxiliary storage while sorting `parent`, such as a merge buffer
+ *
+ * @param parent The `Array` being sorted; the new array gets the observers `parent` has now, so that its accesses are seen too.
+ * Observers tell the two apart by the `Array` they are called with.
+ * @param len The length of the `Array` to create
+ * @param allocator Where the items live; the allocator of an `Array_Arena` takes the items of all the scratch arrays of a sort from one block,
+ * released at once after the arrays were freed
+ * @return `NULL` if `allocator` has no room for the items
+ */
+Array Array_new_scratch_with(Array parent, size_t len, const Array_Allocator *allocator)
+{
+    Array returned = Array_new_with(len, allocator);
+    if (returned == NULL)
+        return NULL;
+    returned->_observer_count = parent->_observer_count;
+    memcpy(returned->_observers, parent->_observers, parent->_observer_count * sizeof(Array_Observer));
+    _Array_update_dispatch(returned);
     return returned;
 }
 
+/** @brief `Array_new_scratch_with` the default allocator */
+Array Array_new_scratch(Array parent, size_t len)
+{
+    return Array_new_scratch_with(parent, len, &Array_malloc_allocator);
+}
+
+/**
+ * @brief Creates a new `Array` of length `len` with items beginning at 0 and increasing by 1 for each item, in memory from `allocator`
+ *
+ * @param len The length of the `Array` to create
+ * @param allocator Where the items live
+ * @return `NULL` if `allocator` has no room for the items
+ */
+Array Array_new_init_with(size_t len, const Array_Allocator *allocator)
+{
+    Array returned = _Array_new_uninitialized(len, allocator);
+    if (returned != NULL)
+        Array_iota(returned, 0, len, 0);
+    return returned;
+}
+
+/**
+ * @brief Creates a new `Array` of length `len` with items beginning at 0 and increasing by 1 for each item
+ *
+ * @param len The length of the `Array` to create
+ */
+Array Array_new_init(size_t len)
+{
+    return Array_new_init_with(len, &Array_malloc_allocator);
+}
+
+/**
+ * @brief Makes room for at least `capacity` items in an `Array`, so that growing it up to that length doesn't reallocate its memory
+ *
+ * @param array The `Array` to reserve memory for
+ * @param capacity The number of items to make room for; `array` is left as it is if it already has room for them
+ * @return `ARRAY_ERR` if the memory couldn't be reallocated, in which case `array` is unchanged; `ARRAY_OK` otherwise
+ */
+Array_ResultCondition Array_reserve(Array array, size_t capacity)
+{
+    if (capacity <= array->capacity)
+        return ARRAY_OK;
+    unsigned int *reallocated = array->_allocator->realloc(array->_allocator->state, array->_arr, array->capacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+    if (reallocated == NULL)
+        return ARRAY_ERR;
+    array->_arr = reallocated;
+    array->capacity = capacity;
+    return ARRAY_OK;
+}
+
 /**
- * @brief Pushes a value to the end of an `Array`
+ * @brief Internal function: makes room for at least `len` items in `array`, at least doubling its capacity when it has to grow
+ * so that growing an `Array` one item at a time takes amortized constant time
+ */
+static Array_ResultCondition _Array_grow(Array array, size_t len)
+{
+    if (len <= array->capacity)
+        return ARRAY_OK;
+    size_t capacity = array->capacity < ARRAY_MIN_CAPACITY / 2 ? ARRAY_MIN_CAPACITY : array->capacity * 2;
+    return Array_reserve(array, capacity < len ? len : capacity);
+}
+
+/**
+ * @brief Frees the memory of an `Array` past its length (left by `Array_pop` or reserved ahead)
+ *
+ * @param array The `Array` to shrink
+ * @return `ARRAY_ERR` if the memory couldn't be reallocated, in which case `array` is unchanged; `ARRAY_OK` otherwise
+ */
+Array_ResultCondition Array_shrink_to_fit(Array array)
+{
+    // an empty array keeps room for one item, so that its memory is never a zero-sized allocation
+    size_t capacity = array->len > 0 ? array->len : 1;
+    if (capacity >= array->capacity)
+        return ARRAY_OK;
+    unsigned int *reallocated = array->_allocator->realloc(array->_allocator->state, array->_arr, array->capacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+    if (reallocated == NULL)
+        return ARRAY_ERR;
+    array->_arr = reallocated;
+    array->capacity = capacity;
+    return ARRAY_OK;
+}
+
+/**
+ * @brief Pushes a value to the end of an `Array`, growing its memory geometrically when it is full
  *
  * @param array The `Array` to push an item to
  * @param value The item to push to `array`
- * @return `Array_ResultCondition` specifying whether the underlying `Array_set` call was successful.
- * Regardless of the return value, `array`'s length will **always** be incremented and its internal memory reallocated.
+ * @return `ARRAY_ERR` if the memory of `array` couldn't be grown, in which case `array` is unchanged; otherwise
+ * `Array_ResultCondition` specifying whether the underlying `Array_set` call was successful.
  */
 Array_ResultCondition Array_push(Array array, unsigned int value)
 {
+    if (_Array_grow(array, array->len + 1) == ARRAY_ERR)
+        return ARRAY_ERR;
     size_t array_prev_len = array->len;
     array->len++;
-    array->_arr = Array_mem_realloc(array->_arr, array->len * sizeof(unsigned int));
     return Array_set(array, array_prev_len, value);
 }
 
 /**
- * @brief Pops a value off the end of an `Array`
+ * @brief Appends `count` values to the end of an `Array` at once, growing its memory geometrically when it is full
+ *
+ * @param array The `Array` to append the values to
+ * @param values The values to append; they may not be in the memory of `array`
+ * @param count The number of values to append
+ * @return `ARRAY_ERR` if the memory of `array` couldn't be grown, in which case `array` is unchanged; `ARRAY_OK` otherwise
+ * @note Reports one write of the appended items to the observers of `array`, like the range operations.
+ */
+Array_ResultCondition Array_append(Array array, const unsigned int *values, size_t count)
+{
+    if (_Array_grow(array, array->len + count) == ARRAY_ERR)
+        return ARRAY_ERR;
+    size_t first = array->len;
+    memcpy(array->_arr + first, values, count * sizeof(unsigned int));
+    array->len += count;
+#ifndef ARRAY_RAW
+    _Array_notify_set_range(array, first, count);
+#endif
+    return ARRAY_OK;
+}
+
+/**
+ * @brief Pops a value off the end of an `Array`. Its memory is kept for later pushes; see `Array_shrink_to_fit`.
  *
  * @param array The `Array` to pop a value off of
  * @return An `Array_Result`. If the return value's `condition` parameter is `ARRAY_ERR`,
- * `array`'s length was not decremented and its internal memory was not reallocated.
+ * `array`'s length was not decremented.
  */
 Array_Result Array_pop(Array array)
 {
@@ -216,7 +1082,6 @@ Array_Result Array_pop(Array array)
     Array_Result returned = Array_at(array, new_array_len);
     if (returned.condition == ARRAY_ERR)
         return returned;
-    array->_arr = Array_mem_realloc(array->_arr, new_array_len);
     array->len = new_array_len;
     return returned;
 }
@@ -230,8 +1095,14 @@ Array_Result Array_pop(Array array)
  * @return `ARRAY_ERR` if any of the internal calls failed; `ARRAY_OK` otherwise.
  * If `ARRAY_ERR` was returned, this also means that the function call returned prematurely.
  */
-Array_ResultCondition Array_swap(Array array, size_t index1, size_t index2)
+ARRAY_ACCESS Array_ResultCondition Array_swap(Array array, size_t index1, size_t index2)
 {
+#ifdef ARRAY_RAW
+    unsigned int value1 = array->_arr[index1];
+    array->_arr[index1] = array->_arr[index2];
+    array->_arr[index2] = value1;
+    return ARRAY_OK;
+#else
     Array_Result value1 = Array_at(array, index1);
     if (value1.condition == ARRAY_ERR)
         return ARRAY_ERR;
@@ -243,6 +1114,7 @@ Array_ResultCondition Array_swap(Array array, size_t index1, size_t index2)
     if (Array_set(array, index2, value1.value) == ARRAY_ERR)
         return ARRAY_ERR;
     return ARRAY_OK;
+#endif
 }
 
 /**
@@ -266,6 +1138,8 @@ Array_Result_Bool Array_reorder(Array array, size_t index1, size_t index2)
         return (Array_Result_Bool){ARRAY_ERR};
     /** @brief `value2.value` */
     unsigned int v2v = value2.value;
+    if (array->_compare != NULL)
+        array->_compare(array->_compare_context, array);
     if (v1v == v2v || (!(index1 > index2 || v1v > v2v) || (index1 > index2 && v1v > v2v)))
         return (Array_Result_Bool){ARRAY_OK, false};
     if (Array_set(array, index1, v2v) == ARRAY_ERR)
@@ -276,26 +1150,33 @@ Array_Result_Bool Array_reorder(Array array, size_t index1, size_t index2)
 }
 
 /**
- * @brief Returns a copy of an `Array`
+ * @brief Returns a copy of an `Array` whose items are in memory from `allocator`
  *
  * @param array the `Array` to copy
- * @return `NULL` if an underlying call to `Array_at` or `Array_set` is unsuccessful; the resulting `Array` otherwise
+ * @param allocator Where the items of the copy live
+ * @return `NULL` if `allocator` has no room for the items; the resulting `Array` otherwise
+ * @note The copy has no observers; its items are read from `array` through `Array_copy_range`, so the observers of `array` see the copy being made
  */
-Array Array_copy(Array array)
+Array Array_copy_with(Array array, const Array_Allocator *allocator)
 {
-    Array returned = Array_new(array->len);
-    for (size_t i = 0; i < returned->len; i++)
-    {
-        Array_Result value = Array_at(array, i);
-        if (value.condition == ARRAY_ERR || Array_set(returned, i, value.value) == ARRAY_ERR)
-        {
-            Array_free(returned);
-            return NULL;
-        }
-    }
+    Array returned = _Array_new_uninitialized(array->len, allocator);
+    if (returned != NULL)
+        Array_copy_range(returned, 0, array, 0, array->len);
     return returned;
 }
 
+/**
+ * @brief Returns a copy of an `Array`, with the default allocator (whatever the allocator of `array` is)
+ *
+ * @param array the `Array` to copy
+ * @return The resulting `Array`
+ * @see Array_copy_with
+ */
+Array Array_copy(Array array)
+{
+    return Array_copy_with(array, &Array_malloc_allocator);
+}
+
 /**
  * @brief Reverses the order of the elements in an `Array`
  *
@@ -304,8 +1185,5 @@ Array Array_copy(Array array)
  */
 Array_ResultCondition Array_reverse(Array array)
 {
-    for (size_t i = 0; i < array->len >> 1; i++)
-        if (Array_swap(array, i, array->len - 1 - i) == ARRAY_ERR)
-            return ARRAY_ERR;
-    return ARRAY_OK;
+    return Array_reverse_range(array, 0, array->len);
 }
\ No newline at end of file
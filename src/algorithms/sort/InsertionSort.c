@@ -0,0 +1,26 @@
+#include "../../Array.c"
+
+static bool _oqiwdqo(Array array)
+{
+    for (size_t i = 1; i < array->len; i++)
+    {
+        Array_Result value = Array_at(array, i);
+        Array_propagate_err(value);
+        size_t j = i;
+        while (j > 0)
+        {
+            Array_Result previous = Array_at(array, j - 1);
+            Array_propagate_err(previous);
+            if (!Array_less(array, value.value, previous.value))
+                break;
+            if (Array_set(array, j, previous.value) == ARRAY_ERR)
+                return false;
+            j--;
+        }
+        if (j != i && Array_set(array, j, value.value) == ARRAY_ERR)
+            return false;
+    }
+    return true;
+}
+
+Algorithm InsertionSort = {_oqiwdqo, "Insertion Sort"};
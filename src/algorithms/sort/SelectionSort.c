@@ -11,7 +11,7 @@ static bool _ewweew(Array array)
         {
             Array_Result j_val = Array_at(array, j);
             Array_propagate_err(j_val);
-            if (j_val.value < min_value.value)
+            if (Array_less(array, j_val.value, min_value.value))
             {
                 min_index = j;
                 min_value.value = j_val.value;
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "raylib.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Consistent views of an array that one thread (the writer) keeps changing, for another thread (the reader) to draw.
+ * The array is copied into one of three buffers: the writer fills one, the last one it published waits to be picked up,
+ * and the reader draws from the third; publishing and picking up just exchange buffer numbers, so neither thread ever waits for the other
+ * and the reader never sees half of an update.
+ * Each buffer remembers which cache lines of the array were written since it was last filled, so publishing only copies those.
+ * Along with the items, every publish carries a fixed-size header (counters, status text...) that stays consistent with them.
+ */
+
+/** The number of items of a cache line of 64 bytes; buffers are updated one line at a time */
+#define ARRAY_SNAPSHOT_LINE_ITEMS 16
+/** Set in `ArraySnapshot.ready` when the buffer it holds was published after the reader last picked one up */
+#define ARRAY_SNAPSHOT_FRESH 4
+
+typedef struct ArraySnapshot
+{
+    size_t len;
+    /** The three copies of the array */
+    unsigned int *buffers[3];
+    /** A header for each buffer, of `header_size` bytes */
+    void *headers[3];
+    size_t header_size;
+    /** For each buffer, one bit per cache line of the array written since the buffer was last filled
+     * @note Only touched by the writer */
+    uint64_t *dirty[3];
+    size_t dirty_words;
+    /** The number of the buffer the writer fills next
+     * @note Only touched by the writer */
+    int writing;
+    /** The number of the buffer the reader draws from
+     * @note Only touched by the reader */
+    int reading;
+    /** The number of the buffer published last, plus `ARRAY_SNAPSHOT_FRESH` if the reader hasn't picked it up yet */
+    atomic_int ready;
+    /** Set by the reader when it wants a new view, cleared by the writer when it publishes one */
+    atomic_bool requested;
+} ArraySnapshot;
+
+/** @brief Sets up `snapshot` for an array of `len` items whose current items are `values`; every buffer starts as a copy of them and of `header` */
+void ArraySnapshot_init(ArraySnapshot *snapshot, const unsigned int *values, size_t len, const void *header, size_t header_size)
+{
+    snapshot->len = len;
+    snapshot->header_size = header_size;
+    snapshot->dirty_words = (len + ARRAY_SNAPSHOT_LINE_ITEMS * 64 - 1) / (ARRAY_SNAPSHOT_LINE_ITEMS * 64);
+    for (int b = 0; b < 3; b++)
+    {
+        snapshot->buffers[b] = MemAlloc(len * sizeof(unsigned int) + 1);
+        memcpy(snapshot->buffers[b], values, len * sizeof(unsigned int));
+        snapshot->headers[b] = MemAlloc(header_size + 1);
+        memcpy(snapshot->headers[b], header, header_size);
+        snapshot->dirty[b] = MemAlloc(snapshot->dirty_words * sizeof(uint64_t) + 1);
+        memset(snapshot->dirty[b], 0, snapshot->dirty_words * sizeof(uint64_t));
+    }
+    snapshot->writing = 0;
+    snapshot->reading = 1;
+    atomic_init(&snapshot->ready, 2);
+    atomic_init(&snapshot->requested, false);
+}
+
+/** @brief Frees the buffers of `snapshot`; neither thread may use it anymore */
+void ArraySnapshot_free(ArraySnapshot *snapshot)
+{
+    for (int b = 0; b < 3; b++)
+    {
+        MemFree(snapshot->buffers[b]);
+        MemFree(snapshot->headers[b]);
+        MemFree(snapshot->dirty[b]);
+    }
+    *snapshot = (ArraySnapshot){0};
+}
+
+/** @brief Records that the item at `index` changed; called by the writer after every write */
+static inline void ArraySnapshot_mark(ArraySnapshot *snapshot, size_t index)
+{
+    size_t line = index / ARRAY_SNAPSHOT_LINE_ITEMS;
+    uint64_t bit = 1ULL << (line & 63);
+    snapshot->dirty[0][line >> 6] |= bit;
+    snapshot->dirty[1][line >> 6] |= bit;
+    snapshot->dirty[2][line >> 6] |= bit;
+}
+
+/** @brief Records that the `count` items from `index` changed; called by the writer after a range write */
+void ArraySnapshot_mark_range(ArraySnapshot *snapshot, size_t index, size_t count)
+{
+    if (count == 0)
+        return;
+    size_t last_line = (index + count - 1) / ARRAY_SNAPSHOT_LINE_ITEMS;
+    for (size_t line = index / ARRAY_SNAPSHOT_LINE_ITEMS; line <= last_line; line++)
+    {
+        uint64_t bit = 1ULL << (line & 63);
+        snapshot->dirty[0][line >> 6] |= bit;
+        snapshot->dirty[1][line >> 6] |= bit;
+        snapshot->dirty[2][line >> 6] |= bit;
+    }
+}
+
+/** @brief Records that every item may have changed (after the writer changed the array without `ArraySnapshot_mark`) */
+void ArraySnapshot_mark_all(ArraySnapshot *snapshot)
+{
+    for (int b = 0; b < 3; b++)
+        memset(snapshot->dirty[b], 0xff, snapshot->dirty_words * sizeof(uint64_t));
+}
+
+/** @return Whether the reader asked for a new view since the last publish; cheap enough to check after every access */
+static inline bool ArraySnapshot_wanted(ArraySnapshot *snapshot)
+{
+    return atomic_load_explicit(&snapshot->requested, memory_order_relaxed);
+}
+
+/**
+ * @brief Publishes the current items of the array (`values`) and `header` as the next view for the reader; called by the writer. Never blocks.
+ * @note Only copies the cache lines written since the buffer being filled was last published, and the header
+ */
+void ArraySnapshot_publish(ArraySnapshot *snapshot, const unsigned int *values, const void *header)
+{
+    int b = snapshot->writing;
+    unsigned int *buffer = snapshot->buffers[b];
+    uint64_t *dirty = snapshot->dirty[b];
+    for (size_t w = 0; w < snapshot->dirty_words; w++)
+    {
+        uint64_t bits = dirty[w];
+        dirty[w] = 0;
+        while (bits != 0)
+        {
+            size_t first = (w * 64 + __builtin_ctzll(bits)) * ARRAY_SNAPSHOT_LINE_ITEMS;
+            bits &= bits - 1;
+            if (first >= snapshot->len)
+                break;
+            size_t count = snapshot->len - first < ARRAY_SNAPSHOT_LINE_ITEMS ? snapshot->len - first : ARRAY_SNAPSHOT_LINE_ITEMS;
+            memcpy(buffer + first, values + first, count * sizeof(unsigned int));
+        }
+    }
+    memcpy(snapshot->headers[b], header, snapshot->header_size);
+    atomic_store_explicit(&snapshot->requested, false, memory_order_relaxed);
+    // the release makes the copies visible to the reader before the buffer number
+    snapshot->writing = atomic_exchange_explicit(&snapshot->ready, b | ARRAY_SNAPSHOT_FRESH, memory_order_acq_rel) & ~ARRAY_SNAPSHOT_FRESH;
+}
+
+/**
+ * @brief Picks up the view published last, if it is newer than the one being read, and asks the writer for the next one; called by the reader once per frame
+ * @return Whether the view changed
+ */
+bool ArraySnapshot_acquire(ArraySnapshot *snapshot)
+{
+    atomic_store_explicit(&snapshot->requested, true, memory_order_relaxed);
+    if (!(atomic_load_explicit(&snapshot->ready, memory_order_relaxed) & ARRAY_SNAPSHOT_FRESH))
+        return false;
+    snapshot->reading = atomic_exchange_explicit(&snapshot->ready, snapshot->reading, memory_order_acq_rel) & ~ARRAY_SNAPSHOT_FRESH;
+    return true;
+}
+
+/** @return The items of the view being read (`snapshot->len` of them); they don't change until the next `ArraySnapshot_acquire` */
+static inline const unsigned int *ArraySnapshot_values(const ArraySnapshot *snapshot)
+{
+    return snapshot->buffers[snapshot->reading];
+}
+
+/** @return The header published with the view being read */
+static inline const void *ArraySnapshot_header(const ArraySnapshot *snapshot)
+{
+    return snapshot->headers[snapshot->reading];
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "raylib.h"
+#include <math.h>
+#include <string.h>
+#include "column_summary.c"
+
+/* The CPU side of drawing an array as bars: colors, bar layout and rasterization into a pixel buffer.
+ * Nothing here talks to the GPU, so it can be used without a window. */
+
+/** The bar colors: untouched, read (blending into GREEN when also written), written (blending into GREEN when also read), both */
+const Color BAR_COLORS[4] = {WHITE, RED, BLUE, GREEN};
+
+/** Helper function to interpolate between colors with a gamma of 2 */
+Color interpolate_colors(Color from, Color to, float t)
+{
+    return (Color){
+        sqrtf((to.r * to.r - from.r * from.r) * t + from.r * from.r),
+        sqrtf((to.g * to.g - from.g * from.g) * t + from.g * from.g),
+        sqrtf((to.b * to.b - from.b * from.b) * t + from.b * from.b),
+        sqrtf((to.a * to.a - from.a * from.a) * t + from.a * from.a)};
+}
+
+/**
+ * @brief Computes the color of a bar from how recently it was accessed
+ * @param read How much of the color of the last read remains (1 right after the read, decaying to 0)
+ * @param write How much of the color of the last write remains (1 right after the write, decaying to 0)
+ */
+Color bar_color(float read, float write)
+{
+    return read > write
+               ? interpolate_colors(BAR_COLORS[0], interpolate_colors(BAR_COLORS[1], BAR_COLORS[3], write / read), read)
+               : interpolate_colors(BAR_COLORS[0], interpolate_colors(BAR_COLORS[2], BAR_COLORS[3], read / write), write);
+}
+
+/** Number of distinct heats (how much of the color of the last access remains) a bar can show */
+#define HEAT_LEVELS 256
+/** Resolution of the heat decay table; heats are looked up from the time since the access, in steps of 1 / `HEAT_DECAY_STEPS_PER_SECOND` seconds */
+#define HEAT_DECAY_STEPS_PER_SECOND 1024.0f
+/** Length of the heat decay table; accesses older than `HEAT_DECAY_STEPS / HEAT_DECAY_STEPS_PER_SECOND` seconds have no heat left */
+#define HEAT_DECAY_STEPS 4096
+
+/** Precomputed tables turning access times into bar colors without `powf` or `sqrtf` */
+typedef struct HeatPalette
+{
+    /** The heat level (0 to `HEAT_LEVELS - 1`) after each step of time since an access */
+    unsigned char decay[HEAT_DECAY_STEPS];
+    /** `bar_color` of every [read heat level][write heat level] */
+    Color colors[HEAT_LEVELS][HEAT_LEVELS];
+} HeatPalette;
+
+/**
+ * @brief Fills `palette`
+ * @param sustain What portion of the color of an access remains 1 second after it
+ */
+void HeatPalette_init(HeatPalette *palette, float sustain)
+{
+    for (int step = 0; step < HEAT_DECAY_STEPS; step++)
+        palette->decay[step] = (unsigned char)((HEAT_LEVELS - 1) * exp2f(step / HEAT_DECAY_STEPS_PER_SECOND * log2f(sustain)) + .5f);
+    for (int read = 0; read < HEAT_LEVELS; read++)
+        for (int write = 0; write < HEAT_LEVELS; write++)
+            palette->colors[read][write] = read == 0 && write == 0 ? BAR_COLORS[0] : bar_color((float)read / (HEAT_LEVELS - 1), (float)write / (HEAT_LEVELS - 1));
+}
+
+/** @return The heat level left at `now` of an access made at `time` */
+static inline unsigned char heat_level(const HeatPalette *palette, float now, float time)
+{
+    float step = (now - time) * HEAT_DECAY_STEPS_PER_SECOND;
+    return step < 0.0f ? palette->decay[0] : step < HEAT_DECAY_STEPS ? palette->decay[(int)step] : 0;
+}
+
+/**
+ * The heat levels of every item of an array. The buffers persist between frames and are only reallocated when the array grows;
+ * a new frame is computed into the back buffers and then flipped to the front, so the front stays a complete frame while the next one is computed.
+ */
+typedef struct HeatBuffers
+{
+    unsigned char *reads[2];
+    unsigned char *writes[2];
+    /** The number of items of the front buffers */
+    size_t len;
+    size_t capacity;
+    /** The index of the front buffers in `reads` and `writes` */
+    int front;
+} HeatBuffers;
+
+/** @brief Computes the heat levels at `now` of the `len` items whose last reads and writes happened at `read_times` and `write_times`, then makes them the front buffers */
+void HeatBuffers_update(HeatBuffers *buffers, const HeatPalette *palette, const float *read_times, const float *write_times, size_t len, float now)
+{
+    if (len > buffers->capacity)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            buffers->reads[i] = MemRealloc(buffers->reads[i], len);
+            buffers->writes[i] = MemRealloc(buffers->writes[i], len);
+        }
+        buffers->capacity = len;
+    }
+    int back = !buffers->front;
+    unsigned char *reads = buffers->reads[back], *writes = buffers->writes[back];
+    for (size_t i = 0; i < len; i++)
+    {
+        reads[i] = heat_level(palette, now, read_times[i]);
+        writes[i] = heat_level(palette, now, write_times[i]);
+    }
+    buffers->len = len;
+    buffers->front = back;
+}
+
+/** @brief Frees the buffers of `buffers`, leaving it empty */
+void HeatBuffers_free(HeatBuffers *buffers)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        MemFree(buffers->reads[i]);
+        MemFree(buffers->writes[i]);
+    }
+    *buffers = (HeatBuffers){0};
+}
+
+/**
+ * A CPU-side image of bars: the height and color of each pixel column, and the RGBA pixels they are rasterized into
+ * (ready to be uploaded with `UpdateTexture` or written to a file).
+ */
+typedef struct BarCanvas
+{
+    int width;
+    int height;
+    /** `width` heights (in pixels, from the bottom) */
+    int *column_height;
+    /** `width` heights up to which columns are solid; between this and `column_height` they are drawn translucent (the min/max envelope of the items of the column) */
+    int *column_floor;
+    /** `width` colors */
+    Color *column_color;
+    /** `width` colors for the translucent part of the columns */
+    Color *column_envelope_color;
+    /** `width * height` pixels, row by row from the top */
+    Color *pixels;
+} BarCanvas;
+
+/** @brief Makes `canvas` `width` by `height` pixels, reallocating its buffers only if the size changed */
+void BarCanvas_resize(BarCanvas *canvas, int width, int height)
+{
+    if (canvas->pixels != NULL && canvas->width == width && canvas->height == height)
+        return;
+    canvas->width = width;
+    canvas->height = height;
+    canvas->column_height = MemRealloc(canvas->column_height, width * sizeof(int));
+    canvas->column_floor = MemRealloc(canvas->column_floor, width * sizeof(int));
+    canvas->column_color = MemRealloc(canvas->column_color, width * sizeof(Color));
+    canvas->column_envelope_color = MemRealloc(canvas->column_envelope_color, width * sizeof(Color));
+    canvas->pixels = MemRealloc(canvas->pixels, (size_t)width * height * sizeof(Color));
+}
+
+/** @brief Frees the buffers of `canvas`, leaving it empty (it can be resized again afterwards) */
+void BarCanvas_free(BarCanvas *canvas)
+{
+    MemFree(canvas->column_height);
+    MemFree(canvas->column_floor);
+    MemFree(canvas->column_color);
+    MemFree(canvas->column_envelope_color);
+    MemFree(canvas->pixels);
+    *canvas = (BarCanvas){0};
+}
+
+/** @brief Removes every bar from `canvas` */
+void BarCanvas_clear(BarCanvas *canvas)
+{
+    memset(canvas->column_height, 0, canvas->width * sizeof(int));
+    memset(canvas->column_floor, 0, canvas->width * sizeof(int));
+}
+
+/** @return The height (in pixels) of the bar of `value` in a `len`-item array holding the values 0 to `len - 1` */
+static inline int BarCanvas_bar_height(const BarCanvas *canvas, unsigned int value, size_t len)
+{
+    return (size_t)(value + 1) * canvas->height / len;
+}
+
+/**
+ * @brief Lays out the bar of item `index` of a `len`-item array holding the values 0 to `len - 1`
+ * @note Bars are one pixel apart when there is room; when there are more items than columns, later items overwrite earlier ones
+ */
+void BarCanvas_set_bar(BarCanvas *canvas, size_t index, size_t len, unsigned int value, Color color)
+{
+    int bar_height = BarCanvas_bar_height(canvas, value, len);
+    int bar_left = (size_t)index * canvas->width / len;
+    int bar_right = (size_t)(index + 1) * canvas->width / len - 1;
+    if (bar_right - bar_left < 1)
+        bar_right = bar_left + 1;
+    if (bar_right > canvas->width)
+        bar_right = canvas->width;
+    for (int column = bar_left; column < bar_right; column++)
+    {
+        canvas->column_height[column] = bar_height;
+        canvas->column_floor[column] = bar_height;
+        canvas->column_color[column] = color;
+    }
+}
+
+/**
+ * @brief Sets pixel column `column` to the summary of several items: solid up to the bar of the smallest one (`min_value`)
+ * and translucent up to the bar of the largest one (`max_value`)
+ */
+void BarCanvas_set_envelope(BarCanvas *canvas, int column, size_t len, unsigned int min_value, unsigned int max_value, Color color)
+{
+    canvas->column_floor[column] = BarCanvas_bar_height(canvas, min_value, len);
+    canvas->column_height[column] = BarCanvas_bar_height(canvas, max_value, len);
+    canvas->column_color[column] = color;
+    canvas->column_envelope_color[column] = (Color){color.r, color.g, color.b, color.a / 2};
+}
+
+/**
+ * @brief Lays out one bar per item of the `len` items of `values` (holding the values 0 to `len - 1`),
+ * colored from the front buffers of `heat`, or all untouched if `heat` is `NULL`
+ */
+void BarCanvas_set_bars(BarCanvas *canvas, const HeatPalette *palette, const HeatBuffers *heat, const unsigned int *values, size_t len)
+{
+    const unsigned char *reads = heat != NULL ? heat->reads[heat->front] : NULL, *writes = heat != NULL ? heat->writes[heat->front] : NULL;
+    for (size_t i = 0; i < len; i++)
+        BarCanvas_set_bar(canvas, i, len, values[i], heat != NULL ? palette->colors[reads[i]][writes[i]] : BAR_COLORS[0]);
+}
+
+/** @brief Lays out every column of `canvas` from `summary` (which has as many columns), colored by the heat left at `now` of the accesses to its items */
+void BarCanvas_set_summary(BarCanvas *canvas, const HeatPalette *palette, const ColumnSummary *summary, float now)
+{
+    for (int column = 0; column < canvas->width; column++)
+    {
+        Color bar = palette->colors[heat_level(palette, now, summary->last_read[column])][heat_level(palette, now, summary->last_write[column])];
+        BarCanvas_set_envelope(canvas, column, summary->len, summary->min[column], summary->max[column], bar);
+    }
+}
+
+/** @brief Fills `canvas->pixels` from the columns; pixels above the bars are set to `background` */
+void BarCanvas_rasterize(BarCanvas *canvas, Color background)
+{
+    for (int row = 0; row < canvas->height; row++)
+    {
+        Color *pixel_row = canvas->pixels + (size_t)row * canvas->width;
+        int min_height = canvas->height - row; // a column reaches this row if it is at least this high
+        for (int column = 0; column < canvas->width; column++)
+            pixel_row[column] = canvas->column_floor[column] >= min_height    ? canvas->column_color[column]
+                                : canvas->column_height[column] >= min_height ? canvas->column_envelope_color[column]
+                                                                              : background;
+    }
+}
@@ -0,0 +1,256 @@
+#include "raylib.h"
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "Array.c"
+#include "algorithms/shuffle/StandardShuffle.c"
+#include "algorithms/sort/SelectionSort.c"
+#include "algorithms/sort/InsertionSort.c"
+
+/*
+ * Headless benchmark of the `Array` primitives and the sorting algorithms.
+ * No window or audio device is opened and no pacing is done: every `Algorithm` runs as fast as the `Array` functions allow.
+ *
+ * Usage: RaylibSortingVisualizerBench [max_size] [trials] [budget_seconds]
+ *
+ * The cost of one call of each access primitive (`Array_at`, `Array_set`, `Array_swap`) is timed first, on an observed array that fits in the L1 cache;
+ * then each algorithm is timed on every size up to `max_size`.
+ * When compiled with `ARRAY_RAW` (`make bench-raw`), both run on the unchecked, callback-free
+ * `Array` functions; the access counts are not available then and are printed as `-`. Comparing the two builds gives the cost of the checks and callbacks.
+ */
+
+/** The algorithms that are benchmarked, in order */
+Algorithm *BENCH_ALGORITHMS[] = {&StandardShuffle, &SelectionSort, &InsertionSort};
+
+/** The array sizes swept over (they stop at `max_size`) */
+const size_t BENCH_SIZES[] = {1000, 10000, 100000, 1000000, 10000000};
+
+/** Arrays of at least this many items are kept in huge pages (see `Array_huge_page_allocator`), which saves TLB misses and page faults at the largest sizes */
+#define BENCH_HUGE_PAGE_ITEMS (1 << 20)
+
+/** @return Where the items of a benchmarked array of `len` items live */
+const Array_Allocator *bench_allocator(size_t len)
+{
+    return len >= BENCH_HUGE_PAGE_ITEMS ? &Array_huge_page_allocator : &Array_malloc_allocator;
+}
+
+/** Number of untimed runs done before the timed trials */
+#define BENCH_WARMUP_RUNS 1
+
+size_t bench_read_count = 0;
+size_t bench_write_count = 0;
+size_t bench_compare_count = 0;
+
+void bench_read_callback(void *context, Array array, size_t index)
+{
+    bench_read_count++;
+}
+
+void bench_write_callback(void *context, Array array, size_t index)
+{
+    bench_write_count++;
+}
+
+void bench_read_range_callback(void *context, Array array, size_t index, size_t count)
+{
+    bench_read_count += count;
+}
+
+void bench_write_range_callback(void *context, Array array, size_t index, size_t count)
+{
+    bench_write_count += count;
+}
+
+void bench_compare_callback(void *context, Array array)
+{
+    bench_compare_count++;
+}
+
+/** @return The current value of the monotonic clock, in seconds */
+double bench_now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/** The number of items of the array the primitives are timed on (a power of 2); small enough to stay in the L1 cache, so that only the calls are measured */
+#define BENCH_PRIMITIVE_ITEMS 4096
+/** The number of calls of a primitive per timed run */
+#define BENCH_PRIMITIVE_CALLS (1 << 24)
+
+/** Where the reads of the timed loops end up, so that the compiler can't drop them */
+volatile unsigned int bench_sink;
+
+/** A loop making `calls` calls of one primitive on `array`, which has `BENCH_PRIMITIVE_ITEMS` items */
+typedef struct BenchPrimitive
+{
+    const char *name;
+    void (*loop)(Array array, size_t calls);
+} BenchPrimitive;
+
+void bench_at_loop(Array array, size_t calls)
+{
+    unsigned int sum = 0;
+    for (size_t i = 0; i < calls; i++)
+        sum += Array_at(array, i & (BENCH_PRIMITIVE_ITEMS - 1)).value;
+    bench_sink = sum;
+}
+
+void bench_set_loop(Array array, size_t calls)
+{
+    for (size_t i = 0; i < calls; i++)
+        Array_set(array, i & (BENCH_PRIMITIVE_ITEMS - 1), (unsigned int)i);
+}
+
+void bench_swap_loop(Array array, size_t calls)
+{
+    // the second index walks with a different stride, so that the two items are rarely the same
+    for (size_t i = 0; i < calls; i++)
+        Array_swap(array, i & (BENCH_PRIMITIVE_ITEMS - 1), (i * 7 + 1) & (BENCH_PRIMITIVE_ITEMS - 1));
+}
+
+/** The primitives that are benchmarked, in order */
+const BenchPrimitive BENCH_PRIMITIVES[] = {{"Array_at", bench_at_loop}, {"Array_set", bench_set_loop}, {"Array_swap", bench_swap_loop}};
+
+/**
+ * @brief Times `primitive` on an array observed like the algorithms' arrays are, and prints its best and mean time per call over `trials` runs
+ * @return `false` if the array could not be made
+ */
+bool bench_primitive(const BenchPrimitive *primitive, int trials)
+{
+    Array array = Array_new_init(BENCH_PRIMITIVE_ITEMS);
+    if (array == NULL)
+        return false;
+    Array_observe(array, (Array_Observer){bench_read_callback, bench_write_callback, bench_compare_callback, NULL, bench_read_range_callback, bench_write_range_callback});
+    double best = 0.0, total = 0.0;
+    for (int t = -BENCH_WARMUP_RUNS; t < trials; t++)
+    {
+        double start = bench_now();
+        primitive->loop(array, BENCH_PRIMITIVE_CALLS);
+        double elapsed = bench_now() - start;
+        if (t < 0)
+            continue;
+        if (t == 0 || elapsed < best)
+            best = elapsed;
+        total += elapsed;
+    }
+    Array_free(array);
+    printf("%-18s %12.2f %12.2f\n", primitive->name, best * 1e9 / BENCH_PRIMITIVE_CALLS, total / trials * 1e9 / BENCH_PRIMITIVE_CALLS);
+    fflush(stdout);
+    return true;
+}
+
+/**
+ * @brief Runs `algorithm` once on a copy of `input`
+ *
+ * @return The time taken by the algorithm in seconds, or a negative value if it returned `false`
+ * @note The access counters are reset before the algorithm starts, so they only hold the algorithm's own accesses afterwards
+ */
+double bench_run(Algorithm *algorithm, Array input)
+{
+    Array work = Array_copy_with(input, bench_allocator(input->len));
+    if (work == NULL)
+        return -1.0;
+    Array_observe(work, (Array_Observer){bench_read_callback, bench_write_callback, bench_compare_callback, NULL, bench_read_range_callback, bench_write_range_callback});
+    bench_read_count = 0;
+    bench_write_count = 0;
+    bench_compare_count = 0;
+    SetRandomSeed(0);
+    double start = bench_now();
+    bool ok = algorithm->fun(work);
+    double elapsed = bench_now() - start;
+    Array_free(work);
+    return ok ? elapsed : -1.0;
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_size = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+    int trials = argc > 2 ? atoi(argv[2]) : 5;
+    // Sizes whose predicted trial time exceeds this are skipped, so that quadratic algorithms don't run for days
+    double budget = argc > 3 ? atof(argv[3]) : 2.0;
+    if (trials < 1)
+        trials = 1;
+
+    printf("%-18s %12s %12s\n", "primitive", "best ns/op", "mean ns/op");
+    for (size_t p = 0; p < sizeof(BENCH_PRIMITIVES) / sizeof(BENCH_PRIMITIVES[0]); p++)
+        if (!bench_primitive(&BENCH_PRIMITIVES[p], trials))
+        {
+            fprintf(stderr, "Benchmark: could not make a %d-element array\n", BENCH_PRIMITIVE_ITEMS);
+            return 1;
+        }
+
+    printf("\n%-18s %10s %12s %12s %14s %14s %14s\n", "algorithm", "size", "best ns/el", "mean ns/el", "reads", "writes", "comparisons");
+    for (size_t a = 0; a < sizeof(BENCH_ALGORITHMS) / sizeof(BENCH_ALGORITHMS[0]); a++)
+    {
+        Algorithm *algorithm = BENCH_ALGORITHMS[a];
+        double previous_time = 0.0, older_time = 0.0;
+        size_t previous_size = 0, older_size = 0;
+        for (size_t s = 0; s < sizeof(BENCH_SIZES) / sizeof(BENCH_SIZES[0]) && BENCH_SIZES[s] <= max_size; s++)
+        {
+            size_t size = BENCH_SIZES[s];
+            if (previous_size)
+            {
+                // Extrapolate using the growth exponent of the last two sizes (assume linear growth until there are two)
+                double exponent = older_size && older_time > 0.0 && previous_time > older_time
+                                      ? log(previous_time / older_time) / log((double)previous_size / older_size)
+                                      : 1.0;
+                double predicted = previous_time * pow((double)size / previous_size, exponent);
+                if (predicted > budget)
+                {
+                    printf("%-18s %10llu %12s (predicted %.1fs per trial, over the %.1fs budget)\n",
+                           algorithm->name, (unsigned long long)size, "skipped", predicted, budget);
+                    continue;
+                }
+            }
+
+            Array input = Array_new_init_with(size, bench_allocator(size));
+            SetRandomSeed(0);
+            if (input == NULL || !StandardShuffle.fun(input))
+            {
+                fprintf(stderr, "Benchmark: could not prepare a %llu-element input\n", (unsigned long long)size);
+                return 1;
+            }
+
+            bool failed = false;
+            for (int w = 0; w < BENCH_WARMUP_RUNS && !failed; w++)
+                failed = bench_run(algorithm, input) < 0.0;
+            double best = 0.0, total = 0.0;
+            for (int t = 0; t < trials && !failed; t++)
+            {
+                double elapsed = bench_run(algorithm, input);
+                failed = elapsed < 0.0;
+                if (t == 0 || elapsed < best)
+                    best = elapsed;
+                total += elapsed;
+            }
+            Array_free(input);
+            if (failed)
+            {
+                fprintf(stderr, "Benchmark: %s returned false on %llu elements\n", algorithm->name, (unsigned long long)size);
+                return 1;
+            }
+
+#ifdef ARRAY_RAW
+            printf("%-18s %10llu %12.2f %12.2f %14s %14s %14s\n",
+                   algorithm->name, (unsigned long long)size,
+                   best * 1e9 / size, total / trials * 1e9 / size,
+                   "-", "-", "-");
+#else
+            printf("%-18s %10llu %12.2f %12.2f %14llu %14llu %14llu\n",
+                   algorithm->name, (unsigned long long)size,
+                   best * 1e9 / size, total / trials * 1e9 / size,
+                   (unsigned long long)bench_read_count, (unsigned long long)bench_write_count,
+                   (unsigned long long)bench_compare_count);
+#endif
+            fflush(stdout);
+
+            older_time = previous_time;
+            older_size = previous_size;
+            previous_time = best;
+            previous_size = size;
+        }
+    }
+    return 0;
+}
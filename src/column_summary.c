@@ -0,0 +1,137 @@
+#pragma once
+
+#include "raylib.h"
+#include <string.h>
+
+/*
+ * Level of detail for arrays wider than the screen: every pixel column stands for a range of items and is drawn from a summary
+ * of that range (the smallest and largest value, and when the range was last read and written).
+ * The summaries are updated as accesses arrive, so drawing a frame costs O(columns) instead of O(items).
+ */
+
+/** Summaries of the pixel columns of an array */
+typedef struct ColumnSummary
+{
+    /** The number of items of the summarized array */
+    size_t len;
+    /** The number of columns */
+    int width;
+    /** A copy of the summarized array as of the last access applied, used to know which value a write replaced */
+    unsigned int *values;
+    /** The smallest value of the items of each column */
+    unsigned int *min;
+    /** The largest value of the items of each column */
+    unsigned int *max;
+    /** The time of the latest read of any item of each column */
+    float *last_read;
+    /** The time of the latest write to any item of each column */
+    float *last_write;
+    /** Whether the extremes of each column have to be recomputed because a write replaced one of them */
+    bool *stale;
+} ColumnSummary;
+
+/** @return The column of `summary` item `index` belongs to */
+static inline int ColumnSummary_column(const ColumnSummary *summary, size_t index)
+{
+    return (size_t)index * summary->width / summary->len;
+}
+
+/** @return The first item of column `column` of `summary` (or `len` for `column == width`) */
+static inline size_t ColumnSummary_first(const ColumnSummary *summary, int column)
+{
+    return ((size_t)column * summary->len + summary->width - 1) / summary->width;
+}
+
+/** @brief Recomputes the smallest and largest value of `column` from `summary->values` */
+void ColumnSummary_rescan(ColumnSummary *summary, int column)
+{
+    size_t first = ColumnSummary_first(summary, column), last = ColumnSummary_first(summary, column + 1);
+    unsigned int min = summary->values[first], max = summary->values[first];
+    for (size_t i = first + 1; i < last; i++)
+    {
+        if (summary->values[i] < min)
+            min = summary->values[i];
+        if (summary->values[i] > max)
+            max = summary->values[i];
+    }
+    summary->min[column] = min;
+    summary->max[column] = max;
+    summary->stale[column] = false;
+}
+
+/**
+ * @brief Rebuilds `summary` for `width` columns of the `len` items of `values`, keeping the access times if the layout didn't change
+ * @note `width` must not be larger than `len`, so that every column has at least one item. Costs O(len).
+ */
+void ColumnSummary_reset(ColumnSummary *summary, const unsigned int *values, size_t len, int width)
+{
+    bool same_layout = summary->len == len && summary->width == width;
+    if (summary->len != len)
+        summary->values = MemRealloc(summary->values, len * sizeof(unsigned int));
+    if (summary->width != width)
+    {
+        summary->min = MemRealloc(summary->min, width * sizeof(unsigned int));
+        summary->max = MemRealloc(summary->max, width * sizeof(unsigned int));
+        summary->last_read = MemRealloc(summary->last_read, width * sizeof(float));
+        summary->last_write = MemRealloc(summary->last_write, width * sizeof(float));
+        summary->stale = MemRealloc(summary->stale, width * sizeof(bool));
+    }
+    summary->len = len;
+    summary->width = width;
+    memcpy(summary->values, values, len * sizeof(unsigned int));
+    if (!same_layout)
+        for (int column = 0; column < width; column++)
+            summary->last_read[column] = summary->last_write[column] = 0.0f;
+    for (int column = 0; column < width; column++)
+        ColumnSummary_rescan(summary, column);
+}
+
+/** @brief Frees the buffers of `summary`, leaving it empty */
+void ColumnSummary_free(ColumnSummary *summary)
+{
+    MemFree(summary->values);
+    MemFree(summary->min);
+    MemFree(summary->max);
+    MemFree(summary->last_read);
+    MemFree(summary->last_write);
+    MemFree(summary->stale);
+    *summary = (ColumnSummary){0};
+}
+
+/** @brief Records that item `index` was read at `time`. O(1). */
+void ColumnSummary_read(ColumnSummary *summary, size_t index, float time)
+{
+    int column = ColumnSummary_column(summary, index);
+    if (time > summary->last_read[column])
+        summary->last_read[column] = time;
+}
+
+/**
+ * @brief Records that `value` was written to item `index` at `time`. O(1).
+ * @note If the write replaced the smallest or largest value of its column with something less extreme,
+ * the column is only marked stale; `ColumnSummary_refresh` rescans it.
+ */
+void ColumnSummary_write(ColumnSummary *summary, size_t index, unsigned int value, float time)
+{
+    int column = ColumnSummary_column(summary, index);
+    unsigned int old_value = summary->values[index];
+    summary->values[index] = value;
+    if (time > summary->last_write[column])
+        summary->last_write[column] = time;
+    if (value <= summary->min[column])
+        summary->min[column] = value;
+    else if (old_value == summary->min[column])
+        summary->stale[column] = true;
+    if (value >= summary->max[column])
+        summary->max[column] = value;
+    else if (old_value == summary->max[column])
+        summary->stale[column] = true;
+}
+
+/** @brief Rescans the columns whose extremes were overwritten since the last call */
+void ColumnSummary_refresh(ColumnSummary *summary)
+{
+    for (int column = 0; column < summary->width; column++)
+        if (summary->stale[column])
+            ColumnSummary_rescan(summary, column);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "raylib.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+/*
+ * Epoch-based reclamation: lets a writer replace something that readers may still be using, without readers taking locks.
+ * A reader marks the span in which it holds pointers (`Epoch_enter`, `Epoch_exit`) with the epoch it started in;
+ * a writer that swapped a pointer retires the old object with the current epoch and moves the epoch on.
+ * The object is freed once every reader is either outside of a span, or in one that started after it was retired,
+ * since such a reader can only have loaded the new pointer.
+ * Entering and leaving a span is one store each, and readers never wait for writers.
+ */
+
+/** The most readers of an `EpochDomain`, each with its own slot */
+#define EPOCH_MAX_READERS 4
+
+typedef struct EpochDomain
+{
+    /** The current epoch; starts at 1 */
+    atomic_uint_fast64_t epoch;
+    /** For each reader, the epoch its current span started in, or 0 outside of a span */
+    atomic_uint_fast64_t readers[EPOCH_MAX_READERS];
+} EpochDomain;
+
+/** An object waiting for the readers that may still use it */
+typedef struct EpochRetired
+{
+    void *pointer;
+    void (*free_pointer)(void *);
+    /** The epoch it was retired in */
+    uint_fast64_t epoch;
+} EpochRetired;
+
+/** The objects retired by one writer and not freed yet
+ * @note Only touched by that writer */
+typedef struct EpochRetireList
+{
+    EpochRetired *items;
+    size_t len;
+    size_t capacity;
+} EpochRetireList;
+
+#define EPOCH_DOMAIN_INIT {1}
+
+/** @brief Starts a span of `reader` in which it may load and use the pointers protected by `domain`; called once per frame, not per pointer */
+void Epoch_enter(EpochDomain *domain, int reader)
+{
+    atomic_store_explicit(&domain->readers[reader], atomic_load_explicit(&domain->epoch, memory_order_relaxed), memory_order_relaxed);
+    // the slot has to be visible to writers before the pointers are loaded
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+/** @brief Ends the span of `reader`; the pointers it loaded may not be used anymore */
+void Epoch_exit(EpochDomain *domain, int reader)
+{
+    atomic_store_explicit(&domain->readers[reader], 0, memory_order_release);
+}
+
+/** @brief Frees the objects of `list` that no reader of `domain` can still use; never waits for readers */
+void Epoch_collect(EpochDomain *domain, EpochRetireList *list)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    uint_fast64_t oldest = UINT_FAST64_MAX;
+    for (int r = 0; r < EPOCH_MAX_READERS; r++)
+    {
+        uint_fast64_t epoch = atomic_load_explicit(&domain->readers[r], memory_order_acquire);
+        if (epoch != 0 && epoch < oldest)
+            oldest = epoch;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < list->len; i++)
+    {
+        if (list->items[i].epoch < oldest)
+            list->items[i].free_pointer(list->items[i].pointer);
+        else
+            list->items[kept++] = list->items[i];
+    }
+    list->len = kept;
+}
+
+/**
+ * @brief Hands `pointer` to `list`, to be freed with `free_pointer` once no reader of `domain` can still use it, and frees what it can
+ * @note To be called after the pointer readers load was replaced, so that readers starting later can't find `pointer`
+ */
+void Epoch_retire(EpochDomain *domain, EpochRetireList *list, void *pointer, void (*free_pointer)(void *))
+{
+    if (list->len == list->capacity)
+    {
+        list->capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+        list->items = MemRealloc(list->items, list->capacity * sizeof(EpochRetired));
+    }
+    uint_fast64_t epoch = atomic_fetch_add_explicit(&domain->epoch, 1, memory_order_seq_cst);
+    list->items[list->len++] = (EpochRetired){pointer, free_pointer, epoch};
+    Epoch_collect(domain, list);
+}
+
+/** @brief Frees everything left in `list`; only once no reader of its domain is running anymore */
+void EpochRetireList_free(EpochRetireList *list)
+{
+    for (size_t i = 0; i < list->len; i++)
+        list->items[i].free_pointer(list->items[i].pointer);
+    MemFree(list->items);
+    *list = (EpochRetireList){0};
+}
@@ -2,21 +2,36 @@
 #include <pthread.h>
 #include "Array.c"
 #include "procedural_audio.c"
+#include "spsc_ring.c"
+#include "bar_raster.c"
+#include "array_snapshot.c"
+#include "epoch.c"
+#include "column_summary.c"
+#include "presortedness.c"
+#include "pacing.c"
+#include "trace_replay.c"
 #include "font_data.h"
 #include "algorithms/shuffle/StandardShuffle.c"
 #include "algorithms/sort/SelectionSort.c"
+#include "algorithms/sort/InsertionSort.c"
 
 /* How long the sound lasts when an array access is made */
 #define SOUND_SUSTAIN 0.05f
 /* What portion of the original color will remain 1 second after an array access */
 #define COLOR_SUSTAIN 1e-1
 
-//The delay to wait every time the sorting algorithm makes an array access (in milliseconds)
+//The delay to wait every time the sorting algorithm makes an array access (in milliseconds), until a sort sets its own
 float array_access_delay = 2.f;
 
 //number of arrays to display and sort!
 int array_nmb = 128;
 
+//If above 0, the sort is paced to last this many seconds (whatever the algorithm and array size) instead of using a fixed delay per access; set with `--duration <seconds>`
+float sort_target_duration = 0.f;
+
+//Arrays up to this size are dry run at full size to count the accesses of a sort; larger ones are extrapolated from two dry runs this size and 4 times smaller
+#define AUTO_PACING_DRY_RUN_MAX 4096
+
 
 //If the macro _WIN32 is not defined (meaning we're not on a Windows platform), then include the code that follows up to the matching #endif directive.  on peut le supprimer mais what if you are running a macOS professor? idk could be helpful im just paranoid like that..
 #ifndef _WIN32
@@ -36,39 +51,184 @@ void strcpy_s(char *restrict dest, size_t destsz, const char *restrict src)
 }
 #endif
 
-//Used in the pause_for macro, which waits until clock() exceeds this value
-float pause;
-
+/** The kind of an `AccessEvent` */
+typedef enum AccessKind
+{
+    ACCESS_READ,
+    ACCESS_WRITE
+} AccessKind;
 
+/** A compact record of one access to the array of a `SortLane`, passed from its sort thread to the render thread */
+typedef struct AccessEvent
+{
+    /** The index of the array that was accessed */
+    unsigned int index;
+    /** An `AccessKind` */
+    unsigned char kind;
+    /** The value of the item after the access */
+    unsigned int value;
+    /** When the access happened (in seconds, from `pacing_seconds`) */
+    float time;
+} AccessEvent;
+
+/* Room for a few frames worth of accesses even at zero delay; the render thread drains it once per frame */
+#define ACCESS_EVENT_CAPACITY (1 << 16)
+SPSC_RING_DEFINE(AccessRing, AccessEvent, ACCESS_EVENT_CAPACITY)
+
+/** What the render thread shows of a lane besides its items, published along with them so that the two always match */
+typedef struct LaneView
+{
+    char status_text[256];
+    size_t read_count;
+    size_t write_count;
+    size_t runs;
+    unsigned long long inversions;
+    unsigned long long displacement;
+    float access_delay;
+    /** The number of accesses per wait of the pacer when the sort has a target duration; 0 otherwise */
+    uint64_t batch_size;
+} LaneView;
+
+/* The most sorts that can race side by side */
+#define MAX_SORT_LANES 8
 
+/**
+ * One sort shown by the visualizer: its array, the thread sorting it, and what the render thread knows of its accesses.
+ * Every lane's array reports to the lane through its own observers (see `SortLane_observe`), so several lanes can sort at once, one thread each.
+ */
+typedef struct SortLane
+{
+    /** The algorithm demonstrated in this lane */
+    Algorithm *sort;
+    /** The `Array` that the sorting algorithm acts on */
+    Array array;
+    pthread_t thread;
+    /** Paces the sort thread of the lane; see pacing.c */
+    Pacer pacer;
+    /** The delay to wait every time the sorting algorithm makes an array access (in milliseconds) */
+    float access_delay;
+    /** Whether the accesses of this lane are heard (through an observer of its arrays); only one lane can be, since `pending_notes` takes sounds from a single thread */
+    bool audible;
+    char status_text[256];
+    size_t read_count;
+    size_t write_count;
+    /** How sorted `array` is; updated by the sort thread on every write and reset whenever `array` is replaced */
+    Presortedness metrics;
+
+    /** The items of `array` and the `LaneView` of the lane, published by the sort thread for the render thread to draw;
+     * replaced by the sort thread when `array` changes length, the previous one being freed once the render thread is done with it (see `render_epoch`) */
+    _Atomic(ArraySnapshot *) snapshot;
+    /** Snapshots replaced by the sort thread that the render thread may still be drawing
+     * @note Only touched by the sort thread */
+    EpochRetireList retired;
+    /** The snapshot drawn in the current frame
+     * @note Only touched by the render thread, and only valid in its `render_epoch` span */
+    ArraySnapshot *drawn;
+    /** The view being drawn: the header of the view of `drawn` being read (or straight from the lane when replaying, since the render thread then owns the array)
+     * @note Only touched by the render thread */
+    LaneView shown;
+
+    /** Accesses made by the sort thread (the producer) waiting to be applied by the render thread (the consumer) */
+    AccessRing events;
+    /** Number of times `array` changed without `events` telling: access events thrown away because `events` was full
+     * (the sort thread never waits for the renderer), and changes made without going through the `Array` functions
+     * @note Counted by the sort thread and read by the render thread, which only compares it to its last value */
+    atomic_size_t unreported_changes;
+
+    /** When each item of `array` was recently read from and written to, for the purpose of generating the colors of the bars
+     * @note Only touched by the render thread; the sort thread reports accesses through `events` */
+    float *reads;
+    size_t read_len;
+    float *writes;
+    size_t write_len;
+    /** Per pixel column summaries of `array`, used to draw it when it has more items than there are columns
+     * @note Only touched by the render thread; kept up to date from `events` */
+    ColumnSummary columns;
+    /** Whether `columns` missed accesses (because events were dropped) and must be rebuilt */
+    bool columns_outdated;
+    /** The value of `unreported_changes` when `columns` was last known to be complete */
+    size_t columns_changes;
+    /** The heat levels of the items of `array`, when it is drawn one bar per item */
+    HeatBuffers heat;
+    /** The CPU-side image of the bars, uploaded to `texture` once per frame */
+    BarCanvas canvas;
+    /** The GPU texture the bars are drawn with; recreated whenever the size of the drawing changes */
+    Texture2D texture;
+} SortLane;
+
+/** The lanes shown side by side; only the first one unless racing */
+SortLane sort_lanes[MAX_SORT_LANES];
+int sort_lane_count = 1;
+
+/** The algorithms raced against each other on the same input when the visualizer is started with `--race`, one lane and one thread each */
+Algorithm *race_algorithms[] = {&SelectionSort, &InsertionSort};
+
+//Intended to be used in the thread of `lane` and no other. Waits until `ms` milliseconds since the last pause_for call (short delays are batched into one wait).
+#define pause_for(lane, ms) Pacer_wait(&(lane)->pacer, ms)
+
+/** Frees the snapshots of the lanes that the render thread stopped drawing; the render thread, its only reader, holds them for one frame at a time */
+EpochDomain render_epoch = EPOCH_DOMAIN_INIT;
+#define RENDER_EPOCH_READER 0
+
+/** @return The current snapshot of `lane`, for its sort thread (the only one replacing it) */
+static inline ArraySnapshot *SortLane_snapshot(SortLane *lane)
+{
+    return atomic_load_explicit(&lane->snapshot, memory_order_relaxed);
+}
 
-//Intended to be used in a single thread and no other. Waits until `ms` milliseconds since the last pause_for call.
-#define pause_for(ms)                    \
-    pause += ms * CLOCKS_PER_SEC / 1000; \
-    while (clock() < pause)              \
-        sched_yield();
+/** @brief Frees a snapshot allocated by `SortLane_new_snapshot` */
+void free_snapshot(void *snapshot)
+{
+    ArraySnapshot_free(snapshot);
+    MemFree(snapshot);
+}
 
-//The `Array` that the sorting algorithms act on
-Array sort_array;
+/** @return The `LaneView` of the current state of `lane`; called by the thread that owns the lane's array */
+LaneView SortLane_view(const SortLane *lane)
+{
+    LaneView view = {"", lane->read_count, lane->write_count, lane->metrics.runs, lane->metrics.inversions, lane->metrics.displacement, lane->access_delay,
+                     lane->pacer.target_end != 0 ? Pacer_batch_size(&lane->pacer, lane->pacer.step_ms) : 0};
+    strcpy_s(view.status_text, sizeof(view.status_text), lane->status_text);
+    return view;
+}
 
-pthread_mutex_t sort_array_read_lock = PTHREAD_ERRORCHECK_MUTEX_INITIALIZER;
-size_t sort_array_read_len = 0;
-/** Keeps track of the array items that were recently read to for the purpose of generating the colors of the bars */
-float *sort_array_reads = NULL;
+/** @brief Publishes the items and the view of `lane` for the render thread; called by the sort thread of the lane. Only copies what changed since. */
+void SortLane_publish(SortLane *lane)
+{
+    LaneView view = SortLane_view(lane);
+    ArraySnapshot_publish(SortLane_snapshot(lane), lane->array->_arr, &view);
+}
 
-pthread_mutex_t sort_array_write_lock = PTHREAD_ERRORCHECK_MUTEX_INITIALIZER;
-size_t sort_array_write_len = 0;
-/** Keeps track of the array items that were recently written to for the purpose of generating the colors of the bars */
-float *sort_array_writes = NULL;
+/** @return A new snapshot of the current array and view of `lane`, to be freed with `free_snapshot` */
+ArraySnapshot *SortLane_new_snapshot(SortLane *lane)
+{
+    ArraySnapshot *snapshot = MemAlloc(sizeof(ArraySnapshot));
+    LaneView view = SortLane_view(lane);
+    ArraySnapshot_init(snapshot, lane->array->_arr, lane->array->len, &view, sizeof(LaneView));
+    return snapshot;
+}
 
-char status_text[256] = "";
+/** @brief Sets the status text of `lane` and publishes it right away, since the sort thread may pause after setting it */
+void SortLane_set_status(SortLane *lane, const char *text)
+{
+    strcpy_s(lane->status_text, sizeof(lane->status_text) - 1, text);
+    SortLane_publish(lane);
+}
 
-size_t array_read_count = 0;
-size_t array_write_count = 0;
+//Publishes a view of `lane` if the render thread asked for one, then waits after an access to its array: its `access_delay`, or whatever keeps the run on its target duration
+void pace_access(SortLane *lane)
+{
+    if (ArraySnapshot_wanted(SortLane_snapshot(lane)))
+        SortLane_publish(lane);
+    if (lane->pacer.target_end != 0)
+        lane->access_delay = Pacer_step(&lane->pacer);
+    else
+        pause_for(lane, lane->access_delay);
+}
 
-/** @note It is assumed that corresponding mutices are locked when this macro is called */
+/** @note Only to be used by the thread that owns `accesses` */
 #define correct_array_length(accesses, access_len, target_len)       \
-    if (access_len != array->len)                                    \
+    if (access_len != target_len)                                    \
     {                                                                \
         accesses = MemRealloc(accesses, target_len * sizeof(float)); \
         for (size_t i = access_len; i < target_len; i++)             \
@@ -76,146 +236,395 @@ size_t array_write_count = 0;
         access_len = target_len;                                     \
     }
 
-#define push_array_access(mutex, accesses, access_len, waveform) \
-    pthread_mutex_lock(mutex);                                   \
-    correct_array_length(accesses, access_len, array->len);      \
-    accesses[index] = (float)clock() / CLOCKS_PER_SEC;           \
-    pthread_mutex_unlock(mutex);                                 \
-    push_sound(waveform, array_access_delay / 500 / SOUND_SUSTAIN, (float)array->_arr[index] / array->len, SOUND_SUSTAIN);
+/*
+ * The observers of the array of a lane, each with the `SortLane` as its context, attached in this order:
+ * the snapshot and the bar colors (which only follow the lane's array, not its scratch arrays), the sound (only on the audible lane), then the counters and the pacing.
+ */
 
-void my_array_read_callback(Array array, size_t index)
+void snapshot_write_callback(void *context, Array array, size_t index)
 {
-    // matensach TODO: make things work with external arrays
+    SortLane *lane = context;
+    if (array == lane->array)
+        ArraySnapshot_mark(SortLane_snapshot(lane), index);
+}
 
-    if (array == sort_array)
-    {
-        push_array_access(&sort_array_read_lock, sort_array_reads, sort_array_read_len, sine_wave);
-        array_read_count++;
-        pause_for(array_access_delay);
-    }
+void snapshot_write_range_callback(void *context, Array array, size_t index, size_t count)
+{
+    SortLane *lane = context;
+    if (array == lane->array)
+        ArraySnapshot_mark_range(SortLane_snapshot(lane), index, count);
 }
 
-void my_array_write_callback(Array array, size_t index)
+#define push_access_event(lane, access_kind)                                                                      \
+    if (array == lane->array &&                                                                                   \
+        !AccessRing_push(&lane->events, (AccessEvent){index, access_kind, array->_arr[index], pacing_seconds()})) \
+        atomic_fetch_add_explicit(&lane->unreported_changes, 1, memory_order_relaxed);
+
+void heat_read_callback(void *context, Array array, size_t index)
 {
-    // matensach TODO: make things work with external arrays
+    SortLane *lane = context;
+    push_access_event(lane, ACCESS_READ);
+}
 
-    if (array == sort_array)
+void heat_write_callback(void *context, Array array, size_t index)
+{
+    SortLane *lane = context;
+    push_access_event(lane, ACCESS_WRITE);
+}
+
+void audio_read_callback(void *context, Array array, size_t index)
+{
+    SortLane *lane = context;
+    push_sound(WAVEFORM_SINE, lane->access_delay / 500 / SOUND_SUSTAIN, (float)array->_arr[index] / array->len, SOUND_SUSTAIN);
+}
+
+void audio_write_callback(void *context, Array array, size_t index)
+{
+    SortLane *lane = context;
+    push_sound(WAVEFORM_TRIANGLE, lane->access_delay / 500 / SOUND_SUSTAIN, (float)array->_arr[index] / array->len, SOUND_SUSTAIN);
+}
+
+void stats_read_callback(void *context, Array array, size_t index)
+{
+    SortLane *lane = context;
+    lane->read_count++;
+    pace_access(lane);
+}
+
+void stats_write_callback(void *context, Array array, size_t index)
+{
+    SortLane *lane = context;
+    if (array == lane->array)
+        Presortedness_write(&lane->metrics, index, array->_arr[index]);
+    lane->write_count++;
+    pace_access(lane);
+}
+
+/** @brief Attaches the observers of `lane` to `array` (the lane's array); called by the lane's sort thread */
+void SortLane_observe(SortLane *lane, Array array)
+{
+    Array_observe(array, (Array_Observer){NULL, snapshot_write_callback, NULL, lane, NULL, snapshot_write_range_callback});
+    Array_observe(array, (Array_Observer){heat_read_callback, heat_write_callback, NULL, lane});
+    if (lane->audible)
+        Array_observe(array, (Array_Observer){audio_read_callback, audio_write_callback, NULL, lane});
+    Array_observe(array, (Array_Observer){stats_read_callback, stats_write_callback, NULL, lane});
+}
+
+/** @brief Replaces the array of `lane` with a new one of `len` items from 0 to `len - 1`, reporting to the lane; called by the lane's sort thread */
+void SortLane_new_array(SortLane *lane, size_t len)
+{
+    Array_free(lane->array);
+    lane->array = Array_new_init(len);
+    SortLane_observe(lane, lane->array);
+    Presortedness_reset(&lane->metrics, lane->array->_arr, lane->array->len);
+    ArraySnapshot *previous = SortLane_snapshot(lane);
+    if (previous->len == len)
+        ArraySnapshot_mark_all(previous);
+    else
     {
-        push_array_access(&sort_array_write_lock, sort_array_writes, sort_array_write_len, triangle_wave);
-        array_write_count++;
-        pause_for(array_access_delay);
+        // the render thread may be drawing the previous snapshot right now: it is freed once the frames that can see it are over
+        atomic_store_explicit(&lane->snapshot, SortLane_new_snapshot(lane), memory_order_release);
+        Epoch_retire(&render_epoch, &lane->retired, previous, free_snapshot);
     }
+    // published first, so that the summary the render thread rebuilds for the change is made from the new items
+    SortLane_publish(lane);
+    atomic_fetch_add_explicit(&lane->unreported_changes, 1, memory_order_relaxed);
 }
 
-/** Helper function to interpolate between colors with a gamma of 2 */
-Color interpolate_colors(Color from, Color to, float t)
+/** Applies every pending event of `lane->events` to its read and write times; called by the render thread once per frame, after loading `lane->drawn` */
+void drain_access_events(SortLane *lane)
 {
-    return (Color){
-        sqrtf((to.r * to.r - from.r * from.r) * t + from.r * from.r),
-        sqrtf((to.g * to.g - from.g * from.g) * t + from.g * from.g),
-        sqrtf((to.b * to.b - from.b * from.b) * t + from.b * from.b),
-        sqrtf((to.a * to.a - from.a * from.a) * t + from.a * from.a)};
+    size_t len = lane->drawn->len;
+    correct_array_length(lane->reads, lane->read_len, len);
+    correct_array_length(lane->writes, lane->write_len, len);
+    bool summarized = lane->columns.len == len;
+    AccessEvent event;
+    while (AccessRing_pop(&lane->events, &event))
+    {
+        if (event.index >= len) // left over from a previous array
+            continue;
+        if (event.kind == ACCESS_READ)
+        {
+            lane->reads[event.index] = event.time;
+            if (summarized)
+                ColumnSummary_read(&lane->columns, event.index, event.time);
+        }
+        else
+        {
+            lane->writes[event.index] = event.time;
+            if (summarized)
+                ColumnSummary_write(&lane->columns, event.index, event.value, event.time);
+        }
+    }
+    size_t changes = atomic_load_explicit(&lane->unreported_changes, memory_order_relaxed);
+    if (changes != lane->columns_changes)
+    {
+        lane->columns_changes = changes;
+        lane->columns_outdated = true;
+    }
 }
 
+/** Whether the visualizer plays a trace (given on the command line) instead of running the sort thread */
+bool replaying = false;
+Trace replay_trace = {0};
+/** Plays `replay_trace` on the array of the first lane; only touched by the render thread */
+TraceReplay replay = {0};
+/** The point of `replay_trace` being shown, in nanoseconds of recorded time */
+double replay_clock_ns = 0.0;
+/** How many times faster than it was recorded the trace is played; negative to play it backwards */
+double replay_speed = 1.0;
+bool replay_paused = false;
+
+/* A frame shows the events it covers one by one (so that they light up and make sound) up to this many; past that, it seeks over them */
+#define REPLAY_MAX_EVENTS_PER_FRAME (1 << 18)
+/* Past this many writes in a frame (or items changed by a seek), the presortedness measures are recounted once instead of updated on every write */
+#define REPLAY_MAX_METRIC_WRITES_PER_FRAME 4096
+
 /**
- * @brief Draws an `Array` onto the screen using Raylib
+ * @brief Moves the replay clock by `frame_time` seconds of playback and brings the array of the first lane to that point of `replay_trace`; called by the render thread once per frame
+ * @note Playing forward shows every event like the sort thread would; playing backwards, or further than `REPLAY_MAX_EVENTS_PER_FRAME` events in one frame,
+ * seeks (one keyframe and a bounded number of events) and only shows the resulting array
  */
-void draw_array(Array array, int width, int height, int x, int y)
+void advance_replay(float frame_time)
 {
-    const Color RECTANGLE_COLORS[4] = {WHITE, RED, BLUE, GREEN};
+    double duration = replay_trace.header.duration_ns;
+    if (!replay_paused)
+        replay_clock_ns += frame_time * 1e9 * replay_speed;
+    if (replay_clock_ns <= 0.0 || replay_clock_ns >= duration)
+    {
+        replay_clock_ns = replay_clock_ns <= 0.0 ? 0.0 : duration;
+        replay_paused = replay_paused || (replay_speed < 0.0) == (replay_clock_ns == 0.0);
+    }
+    uint64_t target = replay_clock_ns;
+
+    SortLane *lane = &sort_lanes[0];
+    size_t len = lane->array->len;
+    bool summarized = lane->columns.len == len;
+    bool seek = target < replay.time_ns;
+    size_t shown = 0, metric_writes = 0;
+    float time = pacing_seconds();
+    uint64_t now = pacing_now();
+    TraceEvent event;
+    while (!seek && TraceReplay_has_next(&replay) && replay.next.time_ns <= target)
+    {
+        if (shown == REPLAY_MAX_EVENTS_PER_FRAME)
+        {
+            seek = true;
+            break;
+        }
+        TraceReplay_step(&replay, &event);
+        shown++;
+        if (event.kind == TRACE_READ)
+        {
+            lane->reads[event.index] = time;
+            if (summarized)
+                ColumnSummary_read(&lane->columns, event.index, time);
+        }
+        else
+        {
+            lane->writes[event.index] = time;
+            if (summarized)
+                ColumnSummary_write(&lane->columns, event.index, event.value, time);
+            if (++metric_writes <= REPLAY_MAX_METRIC_WRITES_PER_FRAME)
+                Presortedness_write(&lane->metrics, event.index, event.value);
+        }
+        // spread the sounds of the frame over it, at the times the events would have happened at this speed
+        push_sound_at(event.kind == TRACE_READ ? WAVEFORM_SINE : WAVEFORM_TRIANGLE, lane->access_delay / 500 / SOUND_SUSTAIN, (float)event.value / len, SOUND_SUSTAIN,
+                      now - (uint64_t)((target - event.time_ns) / replay_speed));
+    }
+    if (seek)
+    {
+        TraceReplay_seek_time(&replay, target);
+        lane->columns_outdated = true;
+    }
+    // only the items the seek (or the writes left out) changed are measured again, so playing backwards doesn't recount every frame
+    if (seek || metric_writes > REPLAY_MAX_METRIC_WRITES_PER_FRAME)
+        Presortedness_sync(&lane->metrics, lane->array->_arr, len, REPLAY_MAX_METRIC_WRITES_PER_FRAME);
+    if (shown > 0)
+        lane->access_delay = frame_time * 1000.f / shown;
+    lane->read_count = replay.read_count;
+    lane->write_count = replay.position - replay.read_count;
+}
 
-    float *reads = NULL;
-    float *writes = NULL;
+/** @brief Handles the playback keys: space pauses, up and down double or halve the speed, R reverses, left and right jump by a twentieth of the trace, home and end jump to its ends */
+void handle_replay_keys()
+{
+    double duration = replay_trace.header.duration_ns;
+    if (IsKeyPressed(KEY_SPACE))
+        replay_paused = !replay_paused;
+    if (IsKeyPressed(KEY_UP))
+        replay_speed *= 2.0;
+    if (IsKeyPressed(KEY_DOWN))
+        replay_speed /= 2.0;
+    if (IsKeyPressed(KEY_R))
+        replay_speed = -replay_speed;
+    if (IsKeyPressed(KEY_RIGHT))
+        replay_clock_ns += duration / 20;
+    if (IsKeyPressed(KEY_LEFT))
+        replay_clock_ns -= duration / 20;
+    if (IsKeyPressed(KEY_HOME))
+        replay_clock_ns = 0.0;
+    if (IsKeyPressed(KEY_END))
+        replay_clock_ns = duration;
+}
 
-    if (array == sort_array)
+/** Turns access times into bar colors; filled in `main` from `COLOR_SUSTAIN` */
+HeatPalette heat_palette;
+/**
+ * @brief Draws the array of `lane` onto the screen using Raylib
+ * @note The bars are rasterized on the CPU and drawn as a single textured quad, so the cost doesn't depend on the number of bars
+ */
+void draw_lane(SortLane *lane, int width, int height, int x, int y)
+{
+    const unsigned int *values = replaying ? lane->array->_arr : ArraySnapshot_values(lane->drawn);
+    size_t len = lane->drawn->len;
+    if (width < 1 || height < 1 || len == 0)
+        return;
+
+    float time = pacing_seconds();
+    bool heated = len <= (size_t)width && lane->read_len == len && lane->write_len == len;
+    if (heated)
+        HeatBuffers_update(&lane->heat, &heat_palette, lane->reads, lane->writes, len, time);
+
+    BarCanvas_resize(&lane->canvas, width, height);
+    BarCanvas_clear(&lane->canvas);
+    if (len > (size_t)width)
     {
-        pthread_mutex_lock(&sort_array_read_lock);
-        pthread_mutex_lock(&sort_array_write_lock);
-
-        correct_array_length(sort_array_reads, sort_array_read_len, array->len);
-        correct_array_length(sort_array_writes, sort_array_write_len, array->len);
-        float time = (float)clock() / CLOCKS_PER_SEC;
-        reads = MemAlloc(array->len * sizeof(float));
-        writes = MemAlloc(array->len * sizeof(float));
-        for (size_t i = 0; i < array->len; i++)
+        // level of detail: one column per pixel, drawn from the summaries of the items it covers
+        if (lane->columns.len != len || lane->columns.width != width || lane->columns_outdated)
         {
-            reads[i] = powf(COLOR_SUSTAIN, time - sort_array_reads[i]);
-            writes[i] = powf(COLOR_SUSTAIN, time - sort_array_writes[i]);
+            ColumnSummary_reset(&lane->columns, values, len, width);
+            lane->columns_outdated = false;
         }
-
-        pthread_mutex_unlock(&sort_array_read_lock);
-        pthread_mutex_unlock(&sort_array_write_lock);
+        ColumnSummary_refresh(&lane->columns);
+        BarCanvas_set_summary(&lane->canvas, &heat_palette, &lane->columns, time);
     }
+    else
+        BarCanvas_set_bars(&lane->canvas, &heat_palette, heated ? &lane->heat : NULL, values, len);
+    BarCanvas_rasterize(&lane->canvas, BLANK);
 
-    for (size_t i = 0; i < array->len; i++)
+    if (lane->texture.width != width || lane->texture.height != height)
     {
-        int rect_height = (array->_arr[i] + 1) * height / array->len;
-        int rect_left = i * width / array->len;
-        int rect_right = (i + 1) * width / array->len - 1;
-        if (rect_right - rect_left < 1)
-            rect_right = rect_left + 1;
-        Color rect_color = reads == NULL || writes == NULL || array != sort_array ? RECTANGLE_COLORS[0] : reads[i] > writes[i]
-            ? interpolate_colors(RECTANGLE_COLORS[0], interpolate_colors(RECTANGLE_COLORS[1], RECTANGLE_COLORS[3], writes[i] / reads[i]), reads[i])
-            : interpolate_colors(RECTANGLE_COLORS[0], interpolate_colors(RECTANGLE_COLORS[2], RECTANGLE_COLORS[3], reads[i] / writes[i]), writes[i]);
-        DrawRectangle(x + rect_left, y + height - rect_height, rect_right - rect_left, rect_height, rect_color);
+        if (lane->texture.id != 0)
+            UnloadTexture(lane->texture);
+        Image image = GenImageColor(width, height, BLANK);
+        lane->texture = LoadTextureFromImage(image);
+        UnloadImage(image);
     }
+    UpdateTexture(lane->texture, lane->canvas.pixels);
+    DrawTexture(lane->texture, x, y, WHITE);
+}
 
-    if (reads != NULL)
-        MemFree(reads);
-    if (writes != NULL)
-        MemFree(writes);
+/** An `Array_CallbackType` counting accesses in the `size_t` `context` */
+void count_access_callback(void *context, Array array, size_t index)
+{
+    (*(size_t *)context)++;
 }
 
-//Demonstrates a sorting algorithm..
-bool show_sort(Algorithm sort, size_t array_size, float delay, Algorithm shuffle)
-{
-    status_text[255] = '\0';
-
-    pause_for(750.f);
-    array_read_count = 0;
-    array_write_count = 0;
-    strcpy_s(status_text, 255, TextFormat("Initializing %llu-element array", array_size));
-    float old_d = array_access_delay;
-    array_access_delay = 0.f; // for instant array initialization
-    Array_free(sort_array);
-    sort_array = Array_new_init(array_size);
-    array_access_delay = old_d;
-    strcpy_s(status_text, 255, "");
-
-    pause_for(750.f);
-    array_read_count = 0;
-    array_write_count = 0;
+/**
+ * @brief Counts the accesses `algorithm` makes on a copy of `input`, without pacing, sound or drawing
+ * @note The copy is made without accessing `input` through the `Array` functions, so it isn't shown either
+ */
+size_t count_accesses(Algorithm algorithm, Array input)
+{
+    size_t access_count = 0;
+    Array copy = Array_new(input->len);
+    memcpy(copy->_arr, input->_arr, input->len * sizeof(unsigned int));
+    Array_observe(copy, (Array_Observer){count_access_callback, count_access_callback, NULL, &access_count});
     SetRandomSeed(0);
-    strcpy_s(status_text, 255, TextFormat("Shuffling: %s (%llu elements)", shuffle.name, array_size));
-    old_d = array_access_delay;
-    array_access_delay = 500.f / 4 / array_size; // 4 array accesses required per element when shuffling
-    if (!shuffle.fun(sort_array))
-        return false;
-    array_access_delay = old_d;
-    strcpy_s(status_text, 255, "");
+    algorithm.fun(copy);
+    Array_free(copy);
+    return access_count;
+}
+
+/**
+ * @brief Estimates the number of accesses `sort` makes on `input` (which was shuffled with `shuffle`)
+ * @note Small inputs are dry run; for larger ones, accesses = c * len^k is fitted to dry runs on two smaller arrays shuffled the same way
+ */
+size_t estimate_accesses(Algorithm sort, Algorithm shuffle, Array input)
+{
+    if (input->len <= AUTO_PACING_DRY_RUN_MAX)
+        return count_accesses(sort, input);
+    const size_t sizes[2] = {AUTO_PACING_DRY_RUN_MAX / 4, AUTO_PACING_DRY_RUN_MAX};
+    double counts[2];
+    for (int i = 0; i < 2; i++)
+    {
+        Array sample = Array_new_init(sizes[i]);
+        SetRandomSeed(0);
+        shuffle.fun(sample);
+        counts[i] = count_accesses(sort, sample);
+        Array_free(sample);
+    }
+    double exponent = counts[0] > 0 && counts[1] > 0 ? log(counts[1] / counts[0]) / log((double)sizes[1] / sizes[0]) : 1.0;
+    return counts[1] * pow((double)input->len / sizes[1], exponent);
+}
+
+//Demonstrates a sorting algorithm in `lane`..
+//If `input` isn't NULL, the sort starts from a copy of it instead of an array shuffled with `shuffle`, so that racing lanes sort the same items.
+bool show_sort(SortLane *lane, Algorithm sort, size_t array_size, float delay, Algorithm shuffle, Array input)
+{
+    pause_for(lane, 750.f);
+    lane->read_count = 0;
+    lane->write_count = 0;
+    SortLane_set_status(lane, TextFormat("Initializing %llu-element array", array_size));
+    SortLane_new_array(lane, array_size);
+    SortLane_set_status(lane, "");
+
+    pause_for(lane, 750.f);
+    lane->read_count = 0;
+    lane->write_count = 0;
+    if (input != NULL)
+    {
+        // the copy isn't made through the `Array` functions, so it is shown all at once
+        memcpy(lane->array->_arr, input->_arr, array_size * sizeof(unsigned int));
+        Presortedness_reset(&lane->metrics, lane->array->_arr, lane->array->len);
+        ArraySnapshot_mark_all(SortLane_snapshot(lane));
+        SortLane_set_status(lane, TextFormat("Shuffled: %s (%llu elements)", shuffle.name, array_size));
+        atomic_fetch_add_explicit(&lane->unreported_changes, 1, memory_order_relaxed);
+    }
+    else
+    {
+        SetRandomSeed(0);
+        SortLane_set_status(lane, TextFormat("Shuffling: %s (%llu elements)", shuffle.name, array_size));
+        lane->access_delay = 500.f / 4 / array_size; // 4 array accesses required per element when shuffling
+        if (!shuffle.fun(lane->array))
+            return false;
+        SortLane_set_status(lane, "");
+    }
 
-    pause_for(750.f);
-    array_read_count = 0;
-    array_write_count = 0;
+    pause_for(lane, 750.f);
+    lane->read_count = 0;
+    lane->write_count = 0;
+    if (sort_target_duration > 0.f)
+    {
+        SortLane_set_status(lane, TextFormat("Estimating: %s (%llu elements)", sort.name, array_size));
+        size_t expected_accesses = estimate_accesses(sort, shuffle, lane->array);
+        Pacer_set_target(&lane->pacer, expected_accesses, sort_target_duration);
+    }
     SetRandomSeed(0);
-    strcpy_s(status_text, 255, TextFormat("Sorting: %s (%llu elements)", sort.name, array_size));
-    old_d = array_access_delay;
-    array_access_delay = delay;
-    if (!sort.fun(sort_array))
+    SortLane_set_status(lane, TextFormat("Sorting: %s (%llu elements)", sort.name, array_size));
+    lane->access_delay = delay;
+    bool sorted = sort.fun(lane->array);
+    Pacer_clear_target(&lane->pacer);
+    if (!sorted)
         return false;
-    array_access_delay = old_d;
-    strcpy_s(status_text, 255, "");
+    lane->access_delay = array_access_delay;
+    SortLane_set_status(lane, TextFormat("Sorted: %s (%llu elements)", sort.name, array_size));
 
     return true;
 }
 
-//NOTE: The arguments and return value are not used; they are only there because this function is called in a new thread
+/** The input every racing lane sorts a copy of; `NULL` when there is a single lane */
+Array race_input = NULL;
+
+//NOTE: The return value is not used; it is only there because this function is called in a new thread. `args` is the `SortLane` to sort in.
 void *sort_proc(void *args)
 {
+    SortLane *lane = args;
     if (
-        !show_sort(SelectionSort, array_nmb, 2.003f, StandardShuffle))
+        !show_sort(lane, *lane->sort, array_nmb, 2.003f, StandardShuffle, race_input))
     {
-        TraceLog(LOG_ERROR, "Sorting Visualizer: algorithm returned false; stopped prematurely");
+        TraceLog(LOG_ERROR, "Sorting Visualizer: %s returned false; stopped prematurely", lane->sort->name);
         return NULL;
     }
     return NULL;
@@ -233,16 +642,58 @@ int previous_window_width = 640;
 /** The window height before enabling fullscreen */
 int previous_window_height = 480;
 
-int main()
+int main(int argc, char **argv)
 {
     SetTraceLogLevel(LOG_ALL);
 
-    sort_array_reads = MemAlloc(0);
-    sort_array_writes = MemAlloc(0);
+    pacing_seconds(); // starts the clock the access times are measured with
+    HeatPalette_init(&heat_palette, COLOR_SUSTAIN);
 
-    Array_set_at_callback(my_array_read_callback);
-    Array_set_set_callback(my_array_write_callback);
-    sort_array = Array_new_init(array_nmb);
+    int arg = 1;
+    if (arg + 1 < argc && strcmp(argv[arg], "--duration") == 0)
+    {
+        // visualizer --duration <seconds> [--race]: every sort is paced to last that long, see `sort_target_duration`
+        sort_target_duration = atof(argv[arg + 1]);
+        arg += 2;
+    }
+    if (arg < argc && strcmp(argv[arg], "--race") == 0)
+    {
+        // visualizer --race: every algorithm of `race_algorithms` sorts its own copy of the same shuffled array, side by side
+        sort_lane_count = sizeof(race_algorithms) / sizeof(race_algorithms[0]);
+        if (sort_lane_count > MAX_SORT_LANES)
+            sort_lane_count = MAX_SORT_LANES;
+        race_input = Array_new_init(array_nmb);
+        SetRandomSeed(0);
+        StandardShuffle.fun(race_input);
+    }
+    else if (arg < argc)
+    {
+        // visualizer <trace file>: play a trace recorded with `make record` instead of sorting
+        if (!Trace_open(&replay_trace, argv[arg]))
+        {
+            TraceLog(LOG_ERROR, "Sorting Visualizer: could not open trace %s", argv[arg]);
+            return 1;
+        }
+        replaying = true;
+    }
+    for (int i = 0; i < sort_lane_count; i++)
+    {
+        SortLane *lane = &sort_lanes[i];
+        lane->sort = sort_lane_count > 1 ? race_algorithms[i] : &SelectionSort;
+        lane->access_delay = array_access_delay;
+        lane->audible = i == 0;
+        lane->reads = MemAlloc(0);
+        lane->writes = MemAlloc(0);
+        lane->array = Array_new(replaying ? replay_trace.header.array_len : array_nmb);
+        if (!replaying)
+            for (size_t j = 0; j < lane->array->len; j++)
+                lane->array->_arr[j] = j;
+        SortLane_observe(lane, lane->array);
+        Presortedness_reset(&lane->metrics, lane->array->_arr, lane->array->len);
+        atomic_init(&lane->snapshot, SortLane_new_snapshot(lane));
+    }
+    if (replaying)
+        TraceReplay_init(&replay, &replay_trace, sort_lanes[0].array);
 
     InitAudioDevice();
     initialize_procedural_audio();
@@ -257,9 +708,12 @@ int main()
     Font font = LoadFontFromMemory(".ttf", font_data, font_data_size, 30, NULL, 0);
     MemFree((void *)font_data);
 
-    pthread_t sort_thread;
-    pause = clock();
-    pthread_create(&sort_thread, NULL, sort_proc, NULL);
+    if (!replaying)
+        for (int i = 0; i < sort_lane_count; i++)
+        {
+            Pacer_start(&sort_lanes[i].pacer);
+            pthread_create(&sort_lanes[i].thread, NULL, sort_proc, &sort_lanes[i]);
+        }
 
     while (!WindowShouldClose())
     {
@@ -278,26 +732,69 @@ int main()
                 ToggleFullscreen();
             }
         }
+        // the snapshots loaded in a frame stay allocated until its end, even if the sort threads replace them meanwhile
+        Epoch_enter(&render_epoch, RENDER_EPOCH_READER);
+        for (int i = 0; i < sort_lane_count; i++)
+        {
+            SortLane *lane = &sort_lanes[i];
+            lane->drawn = atomic_load_explicit(&lane->snapshot, memory_order_acquire);
+            // drained first: a change reported by the sort thread was published before, so the view picked up next includes it
+            drain_access_events(lane);
+            if (!replaying)
+            {
+                ArraySnapshot_acquire(lane->drawn);
+                lane->shown = *(const LaneView *)ArraySnapshot_header(lane->drawn);
+            }
+        }
+        if (replaying)
+        {
+            handle_replay_keys();
+            advance_replay(GetFrameTime());
+            strcpy_s(sort_lanes[0].status_text, 255, TextFormat("Replaying: %.3fs of %.3fs, x%g%s", replay_clock_ns * 1e-9, replay_trace.header.duration_ns * 1e-9,
+                                                                replay_speed, replay_paused ? " (paused)" : ""));
+            sort_lanes[0].shown = SortLane_view(&sort_lanes[0]);
+        }
         BeginDrawing();
         ClearBackground(BLACK);
-        size_t array_runs = 1;
-        for (size_t i = 1; i < sort_array->len; i++)
-            if (sort_array->_arr[i] < sort_array->_arr[i - 1])
-                array_runs++;
-        draw_array(sort_array, GetScreenWidth() - 10, GetScreenHeight() - 10, 5, 5);
-        draw_text_with_line_spacing(
-            font,
-            TextFormat("%s\nArray Accesses: %llu\n\t(%llu reads, %llu writes)\n%llu elements in array (%llu run%s)\nDelay: %.3fms",
-                       status_text,
-                       array_read_count + array_write_count,
-                       array_read_count, array_write_count,
-                       sort_array->len, array_runs, array_runs == 1 ? "" : "s",
-                       array_access_delay),
-            (Vector2){10, 10}, font.baseSize, 0, font.baseSize, WHITE);
+        // split screen: the lanes side by side, each with its own counters
+        int lane_width = GetScreenWidth() / sort_lane_count;
+        for (int i = 0; i < sort_lane_count; i++)
+        {
+            SortLane *lane = &sort_lanes[i];
+            LaneView *shown = &lane->shown;
+            draw_lane(lane, lane_width - 10, GetScreenHeight() - 10, i * lane_width + 5, 5);
+            draw_text_with_line_spacing(
+                font,
+                TextFormat("%s\nArray Accesses: %llu\n\t(%llu reads, %llu writes)\n%llu elements in array (%llu run%s)\n%llu inversions, %llu total displacement\nDelay: %.3fms%s%s",
+                           shown->status_text,
+                           shown->read_count + shown->write_count,
+                           shown->read_count, shown->write_count,
+                           lane->drawn->len, shown->runs, shown->runs == 1 ? "" : "s",
+                           shown->inversions, shown->displacement,
+                           shown->access_delay,
+                           shown->batch_size != 0
+                               ? TextFormat(" (%llu per wait, %.1fs target)", shown->batch_size, sort_target_duration)
+                               : "",
+                           lane->audible
+                               ? TextFormat("\nAudio latency: %.1fms (%.0fms scheduled, %llu late, %llu coalesced)",
+                                            atomic_load_explicit(&audio_measured_latency_ms, memory_order_relaxed), audio_latency_ms,
+                                            atomic_load_explicit(&late_notes, memory_order_relaxed), atomic_load_explicit(&coalesced_notes, memory_order_relaxed))
+                               : ""),
+                (Vector2){i * lane_width + 10, 10}, font.baseSize, 0, font.baseSize, WHITE);
+        }
 
         EndDrawing();
+        Epoch_exit(&render_epoch, RENDER_EPOCH_READER);
     }
 
+    for (int i = 0; i < sort_lane_count; i++)
+    {
+        if (sort_lanes[i].texture.id != 0)
+            UnloadTexture(sort_lanes[i].texture);
+        BarCanvas_free(&sort_lanes[i].canvas);
+        HeatBuffers_free(&sort_lanes[i].heat);
+        ColumnSummary_free(&sort_lanes[i].columns);
+    }
     CloseWindow();
 
     deinitialize_procedural_audio();
@@ -307,11 +804,22 @@ int main()
         #define SIGTERM 15
     #endif
 
-    pthread_kill(sort_thread, SIGTERM);
-    Array_free(sort_array);
-
-    MemFree(sort_array_reads);
-    MemFree(sort_array_writes);
+    if (replaying)
+        Trace_close(&replay_trace);
+    for (int i = 0; i < sort_lane_count; i++)
+    {
+        SortLane *lane = &sort_lanes[i];
+        if (!replaying)
+            pthread_kill(lane->thread, SIGTERM);
+        Array_free(lane->array);
+        Presortedness_free(&lane->metrics);
+        MemFree(lane->reads);
+        MemFree(lane->writes);
+        free_snapshot(SortLane_snapshot(lane));
+        EpochRetireList_free(&lane->retired);
+    }
+    if (race_input != NULL)
+        Array_free(race_input);
 
     return 0;
 }
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sched.h>
+#include <math.h>
+
+/*
+ * Pacing of the sort thread on the monotonic wall clock.
+ * Deadlines are absolute 64-bit nanosecond timestamps, so they don't drift or lose precision however long a run is.
+ * Delays too short for the system timer are not waited on one by one: they accumulate into the deadline and are waited on
+ * together once the deadline is at least `min_wait_ns` away.
+ */
+
+#ifdef _WIN32
+/* Windows sleeps overshoot by up to a scheduler tick, so more of the wait is spent spinning */
+#define PACING_DEFAULT_SPIN_NS 2000000ULL
+#else
+#define PACING_DEFAULT_SPIN_NS 200000ULL
+#endif
+/** How far ahead a deadline has to be before it is waited on, by default */
+#define PACING_DEFAULT_MIN_WAIT_NS 1000000ULL
+/** How far behind its deadline a pacer may fall (after a stall) before it gives up catching up */
+#define PACING_MAX_LAG_NS 50000000ULL
+
+/** @return The current value of the monotonic clock, in nanoseconds */
+static inline uint64_t pacing_now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/** @brief Internal value: the time `pacing_seconds` counts from */
+static uint64_t _pacing_epoch = 0;
+
+/**
+ * @return The number of seconds since the first call, as a float
+ * @note A float keeps 24 significant bits: the result is precise to a millisecond (about the steps heats decay in) for the first 2 hours or so,
+ * then half as precise each time the run length doubles, down to 8 ms after a day. Use `pacing_now` where that isn't enough
+ */
+float pacing_seconds()
+{
+    if (_pacing_epoch == 0)
+        _pacing_epoch = pacing_now();
+    return (pacing_now() - _pacing_epoch) * 1e-9f;
+}
+
+/** Paces one thread by waiting until successive deadlines */
+typedef struct Pacer
+{
+    /** The time (from `pacing_now`) the next wait ends */
+    uint64_t deadline;
+    /** The last this many nanoseconds before a deadline are spun (yielding) instead of slept, to absorb sleep overshoot */
+    uint64_t spin_ns;
+    /** Deadlines closer than this are not waited on yet; shorter delays pile up until they are worth a wait */
+    uint64_t min_wait_ns;
+    /** The number of times the pacer actually waited, and the number of delays requested */
+    uint64_t waits;
+    uint64_t delays;
+    /** Target duration mode (see `Pacer_set_target`): when the run should end (0 when not in this mode) */
+    uint64_t target_end;
+    /** Target duration mode: the number of steps the run is expected to take, and the number taken so far */
+    uint64_t expected_steps;
+    uint64_t steps;
+    /** Target duration mode: the delay (in milliseconds) of the latest step */
+    double step_ms;
+} Pacer;
+
+/** @brief (Re)starts `pacer` at the current time */
+void Pacer_start(Pacer *pacer)
+{
+    pacer->deadline = pacing_now();
+    if (pacer->spin_ns == 0)
+        pacer->spin_ns = PACING_DEFAULT_SPIN_NS;
+    if (pacer->min_wait_ns == 0)
+        pacer->min_wait_ns = PACING_DEFAULT_MIN_WAIT_NS;
+}
+
+/** @brief Sleeps, then spins, until the monotonic clock reaches `deadline` */
+void pacing_wait_until(uint64_t deadline, uint64_t spin_ns)
+{
+    uint64_t now = pacing_now();
+    if (deadline > now + spin_ns)
+    {
+        uint64_t sleep_ns = deadline - now - spin_ns;
+        struct timespec duration = {sleep_ns / 1000000000ULL, sleep_ns % 1000000000ULL};
+        nanosleep(&duration, NULL);
+    }
+    while (pacing_now() < deadline)
+        sched_yield();
+}
+
+/**
+ * @brief Waits until `ms` milliseconds after the end of the previous wait of `pacer`.
+ * Intended to be used in a single thread and no other.
+ * @note If the delay is below `min_wait_ns`, it is usually only added to the deadline; the thread keeps running and waits once several delays add up.
+ */
+void Pacer_wait(Pacer *pacer, double ms)
+{
+    pacer->delays++;
+    pacer->deadline += (uint64_t)(ms * 1e6);
+    uint64_t now = pacing_now();
+    if (pacer->deadline <= now)
+    {
+        if (now - pacer->deadline > PACING_MAX_LAG_NS)
+            pacer->deadline = now - PACING_MAX_LAG_NS;
+        return;
+    }
+    if (pacer->deadline - now < pacer->min_wait_ns)
+        return;
+    pacer->waits++;
+    pacing_wait_until(pacer->deadline, pacer->spin_ns);
+}
+
+/**
+ * @brief Puts `pacer` in target duration mode: `Pacer_step` will pick its delays so that `expected_steps` steps end `seconds` from now
+ * @note The delays are recomputed at every step from the time and steps left, so a slow start or a wrong estimate is corrected as the run goes;
+ * if the run takes more steps than expected, the estimate is raised and the remaining steps run without delay since the time is up.
+ */
+void Pacer_set_target(Pacer *pacer, uint64_t expected_steps, double seconds)
+{
+    Pacer_start(pacer);
+    pacer->target_end = pacer->deadline + (uint64_t)(seconds * 1e9);
+    pacer->expected_steps = expected_steps > 0 ? expected_steps : 1;
+    pacer->steps = 0;
+    pacer->step_ms = 0.0;
+}
+
+/** @brief Leaves target duration mode */
+void Pacer_clear_target(Pacer *pacer)
+{
+    pacer->target_end = 0;
+}
+
+/**
+ * @brief Takes one step of a run in target duration mode, waiting as needed to end on time
+ * @return The delay of this step, in milliseconds
+ */
+double Pacer_step(Pacer *pacer)
+{
+    pacer->steps++;
+    if (pacer->steps > pacer->expected_steps)
+        pacer->expected_steps = pacer->steps + pacer->steps / 4 + 1;
+    uint64_t time_left = pacer->target_end > pacer->deadline ? pacer->target_end - pacer->deadline : 0;
+    pacer->step_ms = (double)time_left / (pacer->expected_steps - pacer->steps + 1) / 1e6;
+    Pacer_wait(pacer, pacer->step_ms);
+    return pacer->step_ms;
+}
+
+/** @return The number of steps (or delays) of `pacer` that are currently batched into a single wait */
+uint64_t Pacer_batch_size(const Pacer *pacer, double step_ms)
+{
+    double step_ns = step_ms * 1e6;
+    return step_ns >= pacer->min_wait_ns ? 1 : step_ns <= 0.0 ? 0 : (uint64_t)ceil(pacer->min_wait_ns / step_ns);
+}
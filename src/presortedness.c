@@ -0,0 +1,285 @@
+#pragma once
+
+#include "raylib.h"
+#include <math.h>
+#include <string.h>
+
+/*
+ * Measures of how sorted an array is, kept up to date on every write instead of being recounted every frame:
+ *  - runs: the number of ascending runs (1 when sorted)
+ *  - inversions: the number of pairs of items that are in the wrong order (0 when sorted)
+ *  - displacement: the sum of the distances of the items from their sorted positions (0 when sorted),
+ *    assuming the array holds the values 0 to `len - 1` like the arrays made by `Array_new_init`
+ *
+ * Counting the inversions a write adds or removes needs the number of earlier items that are larger and of later items that are smaller.
+ * Positions and values are both split into about sqrt(len) buckets; a 2D Fenwick tree counts the items of every (position bucket, value bucket)
+ * pair, and the two partial buckets are scanned, so a write costs O(sqrt(len)) instead of O(len).
+ */
+
+/** Presortedness measures of an array, see the top of this file */
+typedef struct Presortedness
+{
+    size_t runs;
+    unsigned long long inversions;
+    unsigned long long displacement;
+
+    /** The number of items of the measured array */
+    size_t len;
+    /** A copy of the measured array, used to know which value a write replaced */
+    unsigned int *values;
+    /** The number of positions (and values) per bucket */
+    size_t bucket_size;
+    /** The number of position buckets (and value buckets) */
+    size_t buckets;
+    /** `buckets * buckets` 2D Fenwick tree indexed by [position bucket][value bucket] counting items */
+    unsigned int *grid;
+    /** For each value bucket, the positions of the items whose value is in it */
+    unsigned int **members;
+    size_t *member_count;
+    size_t *member_capacity;
+    /** For each position, where it is in the `members` list of its value bucket */
+    unsigned int *member_slot;
+} Presortedness;
+
+/** @return The value bucket of `value` (values past the end go to the last bucket) */
+static inline size_t Presortedness_value_bucket(const Presortedness *metrics, unsigned int value)
+{
+    size_t bucket = value / metrics->bucket_size;
+    return bucket < metrics->buckets ? bucket : metrics->buckets - 1;
+}
+
+/** @brief Adds `delta` to the count of grid cell [`position_bucket`][`value_bucket`] */
+static void Presortedness_grid_add(Presortedness *metrics, size_t position_bucket, size_t value_bucket, int delta)
+{
+    for (size_t p = position_bucket + 1; p <= metrics->buckets; p += p & -p)
+        for (size_t v = value_bucket + 1; v <= metrics->buckets; v += v & -v)
+            metrics->grid[(p - 1) * metrics->buckets + v - 1] += delta;
+}
+
+/** @return The number of items whose position bucket is below `position_buckets` and whose value bucket is below `value_buckets` */
+static size_t Presortedness_grid_count(const Presortedness *metrics, size_t position_buckets, size_t value_buckets)
+{
+    size_t count = 0;
+    for (size_t p = position_buckets; p > 0; p -= p & -p)
+        for (size_t v = value_buckets; v > 0; v -= v & -v)
+            count += metrics->grid[(p - 1) * metrics->buckets + v - 1];
+    return count;
+}
+
+static void Presortedness_add_member(Presortedness *metrics, size_t value_bucket, size_t position)
+{
+    if (metrics->member_count[value_bucket] == metrics->member_capacity[value_bucket])
+    {
+        metrics->member_capacity[value_bucket] = metrics->member_capacity[value_bucket] * 2 + 4;
+        metrics->members[value_bucket] = MemRealloc(metrics->members[value_bucket], metrics->member_capacity[value_bucket] * sizeof(unsigned int));
+    }
+    metrics->member_slot[position] = metrics->member_count[value_bucket];
+    metrics->members[value_bucket][metrics->member_count[value_bucket]++] = position;
+}
+
+static void Presortedness_remove_member(Presortedness *metrics, size_t value_bucket, size_t position)
+{
+    unsigned int slot = metrics->member_slot[position];
+    unsigned int last = metrics->members[value_bucket][--metrics->member_count[value_bucket]];
+    metrics->members[value_bucket][slot] = last;
+    metrics->member_slot[last] = slot;
+}
+
+/** @return The number of items before `index` (not counting it) whose value is larger than `value` */
+static size_t Presortedness_larger_before(const Presortedness *metrics, size_t index, unsigned int value)
+{
+    size_t position_bucket = index / metrics->bucket_size, value_bucket = Presortedness_value_bucket(metrics, value);
+    size_t first_partial = position_bucket * metrics->bucket_size;
+    // whole position buckets before the one of `index`, values in later value buckets
+    size_t count = Presortedness_grid_count(metrics, position_bucket, metrics->buckets) - Presortedness_grid_count(metrics, position_bucket, value_bucket + 1);
+    // whole position buckets, values in the same value bucket
+    for (size_t m = 0; m < metrics->member_count[value_bucket]; m++)
+    {
+        unsigned int position = metrics->members[value_bucket][m];
+        count += position < first_partial && metrics->values[position] > value;
+    }
+    // the start of the position bucket of `index`
+    for (size_t i = first_partial; i < index; i++)
+        count += metrics->values[i] > value;
+    return count;
+}
+
+/** @return The number of items after `index` (not counting it) whose value is smaller than `value` */
+static size_t Presortedness_smaller_after(const Presortedness *metrics, size_t index, unsigned int value)
+{
+    size_t position_bucket = index / metrics->bucket_size, value_bucket = Presortedness_value_bucket(metrics, value);
+    size_t end_partial = (position_bucket + 1) * metrics->bucket_size;
+    if (end_partial > metrics->len)
+        end_partial = metrics->len;
+    // whole position buckets after the one of `index`, values in earlier value buckets
+    size_t count = Presortedness_grid_count(metrics, metrics->buckets, value_bucket) - Presortedness_grid_count(metrics, position_bucket + 1, value_bucket);
+    // whole position buckets, values in the same value bucket
+    for (size_t m = 0; m < metrics->member_count[value_bucket]; m++)
+    {
+        unsigned int position = metrics->members[value_bucket][m];
+        count += position >= end_partial && metrics->values[position] < value;
+    }
+    // the end of the position bucket of `index`
+    for (size_t i = index + 1; i < end_partial; i++)
+        count += metrics->values[i] < value;
+    return count;
+}
+
+/** @return The number of pairs out of order in `values`, counted with a merge sort using `scratch` (both `len` long, `values` is sorted afterwards) */
+static unsigned long long Presortedness_count_inversions(unsigned int *values, unsigned int *scratch, size_t len)
+{
+    unsigned long long inversions = 0;
+    for (size_t width = 1; width < len; width *= 2)
+    {
+        for (size_t left = 0; left < len; left += 2 * width)
+        {
+            size_t middle = left + width < len ? left + width : len, right = left + 2 * width < len ? left + 2 * width : len;
+            size_t i = left, j = middle, k = left;
+            while (i < middle && j < right)
+                if (values[j] < values[i])
+                {
+                    inversions += middle - i;
+                    scratch[k++] = values[j++];
+                }
+                else
+                    scratch[k++] = values[i++];
+            while (i < middle)
+                scratch[k++] = values[i++];
+            while (j < right)
+                scratch[k++] = values[j++];
+        }
+        memcpy(values, scratch, len * sizeof(unsigned int));
+    }
+    return inversions;
+}
+
+static inline unsigned int Presortedness_distance(unsigned int value, size_t index)
+{
+    return value > index ? value - index : index - value;
+}
+
+/** @brief Frees the buffers of `metrics`, leaving it empty */
+void Presortedness_free(Presortedness *metrics)
+{
+    for (size_t b = 0; b < metrics->buckets; b++)
+        MemFree(metrics->members[b]);
+    MemFree(metrics->members);
+    MemFree(metrics->member_count);
+    MemFree(metrics->member_capacity);
+    MemFree(metrics->member_slot);
+    MemFree(metrics->grid);
+    MemFree(metrics->values);
+    *metrics = (Presortedness){0};
+}
+
+/** @brief Measures the `len` items of `values` from scratch. Costs O(len log len). */
+void Presortedness_reset(Presortedness *metrics, const unsigned int *values, size_t len)
+{
+    Presortedness_free(metrics);
+    metrics->runs = len > 0;
+    if (len == 0)
+        return;
+    metrics->len = len;
+    metrics->bucket_size = (size_t)ceil(sqrt((double)len));
+    metrics->buckets = (len + metrics->bucket_size - 1) / metrics->bucket_size;
+    metrics->values = MemAlloc(len * sizeof(unsigned int));
+    memcpy(metrics->values, values, len * sizeof(unsigned int));
+
+    unsigned int *sorted = MemAlloc(len * sizeof(unsigned int)), *scratch = MemAlloc(len * sizeof(unsigned int));
+    memcpy(sorted, values, len * sizeof(unsigned int));
+    metrics->inversions = Presortedness_count_inversions(sorted, scratch, len);
+    MemFree(sorted);
+    MemFree(scratch);
+
+    metrics->grid = MemAlloc(metrics->buckets * metrics->buckets * sizeof(unsigned int));
+    memset(metrics->grid, 0, metrics->buckets * metrics->buckets * sizeof(unsigned int));
+    metrics->members = MemAlloc(metrics->buckets * sizeof(unsigned int *));
+    metrics->member_count = MemAlloc(metrics->buckets * sizeof(size_t));
+    metrics->member_capacity = MemAlloc(metrics->buckets * sizeof(size_t));
+    metrics->member_slot = MemAlloc(len * sizeof(unsigned int));
+    memset(metrics->members, 0, metrics->buckets * sizeof(unsigned int *));
+    memset(metrics->member_count, 0, metrics->buckets * sizeof(size_t));
+    memset(metrics->member_capacity, 0, metrics->buckets * sizeof(size_t));
+
+    for (size_t i = 0; i < len; i++)
+    {
+        size_t value_bucket = Presortedness_value_bucket(metrics, values[i]);
+        metrics->grid[i / metrics->bucket_size * metrics->buckets + value_bucket]++;
+        Presortedness_add_member(metrics, value_bucket, i);
+        metrics->displacement += Presortedness_distance(values[i], i);
+        if (i > 0 && values[i] < values[i - 1])
+            metrics->runs++;
+    }
+    // turn the counts into a 2D Fenwick tree in place: first along the value buckets, then along the position buckets
+    size_t n = metrics->buckets;
+    for (size_t p = 0; p < n; p++)
+        for (size_t v = 1; v <= n; v++)
+            if (v + (v & -v) <= n)
+                metrics->grid[p * n + v + (v & -v) - 1] += metrics->grid[p * n + v - 1];
+    for (size_t p = 1; p <= n; p++)
+        if (p + (p & -p) <= n)
+            for (size_t v = 0; v < n; v++)
+                metrics->grid[(p + (p & -p) - 1) * n + v] += metrics->grid[(p - 1) * n + v];
+}
+
+/** @return 1 if items `index - 1` and `index` of `metrics` are out of order (a run ends between them), 0 otherwise */
+static inline size_t Presortedness_descent(const Presortedness *metrics, size_t index)
+{
+    return index > 0 && index < metrics->len && metrics->values[index] < metrics->values[index - 1];
+}
+
+/** @brief Updates `metrics` after `value` was written to item `index`. Costs O(sqrt(len)). */
+void Presortedness_write(Presortedness *metrics, size_t index, unsigned int value)
+{
+    if (index >= metrics->len)
+        return;
+    unsigned int old_value = metrics->values[index];
+    if (old_value == value)
+        return;
+
+    metrics->runs -= Presortedness_descent(metrics, index) + Presortedness_descent(metrics, index + 1);
+    metrics->displacement -= Presortedness_distance(old_value, index);
+    metrics->inversions -= Presortedness_larger_before(metrics, index, old_value) + Presortedness_smaller_after(metrics, index, old_value);
+
+    size_t old_bucket = Presortedness_value_bucket(metrics, old_value), new_bucket = Presortedness_value_bucket(metrics, value);
+    if (old_bucket != new_bucket)
+    {
+        Presortedness_grid_add(metrics, index / metrics->bucket_size, old_bucket, -1);
+        Presortedness_grid_add(metrics, index / metrics->bucket_size, new_bucket, 1);
+        Presortedness_remove_member(metrics, old_bucket, index);
+        Presortedness_add_member(metrics, new_bucket, index);
+    }
+    metrics->values[index] = value;
+
+    metrics->inversions += Presortedness_larger_before(metrics, index, value) + Presortedness_smaller_after(metrics, index, value);
+    metrics->displacement += Presortedness_distance(value, index);
+    metrics->runs += Presortedness_descent(metrics, index) + Presortedness_descent(metrics, index + 1);
+}
+
+/**
+ * @brief Brings `metrics` up to date with the `len` items of `values`, which may have changed anywhere since it last saw them (after a seek, say):
+ * each changed item is written like by `Presortedness_write`, unless the length changed or more than `max_writes` items did, then everything is recounted.
+ * Costs O(len) to find the changes, without allocating, plus O(sqrt(len)) per change.
+ */
+void Presortedness_sync(Presortedness *metrics, const unsigned int *values, size_t len, size_t max_writes)
+{
+    if (len != metrics->len)
+    {
+        Presortedness_reset(metrics, values, len);
+        return;
+    }
+    size_t changed = 0;
+    for (size_t i = 0; i < len && changed <= max_writes; i++)
+        changed += values[i] != metrics->values[i];
+    if (changed > max_writes)
+    {
+        Presortedness_reset(metrics, values, len);
+        return;
+    }
+    for (size_t i = 0; changed > 0; i++)
+        if (values[i] != metrics->values[i])
+        {
+            Presortedness_write(metrics, i, values[i]);
+            changed--;
+        }
+}
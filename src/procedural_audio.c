@@ -1,133 +1,547 @@
 #include "raylib.h"
 #include <string.h>
 #include <math.h>
-#include <pthread.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "spsc_ring.c"
+#include "pacing.c"
 
 #define SAMPLE_RATE 44100
 
-float sine_wave(float x)
+float frequency(float value)
 {
-    return sinf(2 * PI * x);
+    /*The strong peak at approximately 1320 Hz is the fundamental for E6 c'est pour ca on a choice 1320*/
+    return 1320.0f * value;
 }
 
-float triangle_wave(float x)
+/** The shape of a sound's wave */
+typedef enum Waveform
 {
-    float intermediate = fmod(x + .25f, 1.0f);
-    return intermediate < .5f ? 4 * intermediate - 1 : -4 * intermediate + 3;
-}
-
-
-/* // Unused wave functions
-
-float square_wave(float x) {
-    return fmod(x, 1.0f) < .5f ? 1.0f : -1.0f;
-}
+    WAVEFORM_SINE,
+    WAVEFORM_TRIANGLE,
+    WAVEFORM_SQUARE,
+    WAVEFORM_SAWTOOTH,
+    WAVEFORM_COUNT
+} Waveform;
 
-float sawtooth_wave(float x) {
-    return fmod(2 * x + 1, 2.0f) - 1.0f;
-}
+/** log2 of the number of samples in one cycle of a wavetable */
+#define WAVETABLE_BITS 11
+#define WAVETABLE_SIZE (1 << WAVETABLE_BITS)
+/** Number of band-limited versions of each waveform; band `b` has no harmonics above Nyquist for fundamentals up to `WAVETABLE_BASE_FREQUENCY * 2^b` */
+#define WAVETABLE_BANDS 8
+#define WAVETABLE_BASE_FREQUENCY 20.0f
 
-float no_wave(float x) {
-    return 0.0f;
-}
-*/
+/**
+ * One cycle of every waveform for every band, plus a copy of the first sample at the end so that interpolation never wraps.
+ * Built from the Fourier series of the waves, which were defined as:
+ *     sine:     sinf(2 * PI * x)
+ *     triangle: fmod(x + .25f, 1.0f) < .5f ? 4 * fmod(x + .25f, 1.0f) - 1 : -4 * fmod(x + .25f, 1.0f) + 3
+ *     square:   fmod(x, 1.0f) < .5f ? 1.0f : -1.0f
+ *     sawtooth: fmod(2 * x + 1, 2.0f) - 1.0f
+ */
+float wavetables[WAVEFORM_COUNT][WAVETABLE_BANDS][WAVETABLE_SIZE + 1];
+bool wavetables_initialized = false;
 
-float frequency(float value)
+/** Fills `wavetables`; does nothing if it was already called */
+void initialize_wavetables()
 {
-    /*The strong peak at approximately 1320 Hz is the fundamental for E6 c'est pour ca on a choice 1320*/
-    return 1320.0f * value;
+    if (wavetables_initialized)
+        return;
+    static float sine_table[WAVETABLE_SIZE];
+    for (int i = 0; i < WAVETABLE_SIZE; i++)
+        sine_table[i] = sinf(2 * PI * i / WAVETABLE_SIZE);
+    for (int band = 0; band < WAVETABLE_BANDS; band++)
+    {
+        int harmonics = (int)(SAMPLE_RATE / 2 / (WAVETABLE_BASE_FREQUENCY * (1 << band)));
+        if (harmonics > WAVETABLE_SIZE / 2 - 1)
+            harmonics = WAVETABLE_SIZE / 2 - 1;
+        for (int waveform = 0; waveform < WAVEFORM_COUNT; waveform++)
+        {
+            float *table = wavetables[waveform][band];
+            memset(table, 0, sizeof(wavetables[waveform][band]));
+            for (int h = 1; h <= harmonics; h++)
+            {
+                float weight;
+                if (waveform == WAVEFORM_SINE)
+                    weight = h == 1;
+                else if (waveform == WAVEFORM_TRIANGLE)
+                    weight = h % 2 ? (h % 4 == 1 ? 8 : -8) / (PI * PI * h * h) : 0.0f;
+                else if (waveform == WAVEFORM_SQUARE)
+                    weight = h % 2 ? 4 / (PI * h) : 0.0f;
+                else
+                    weight = (h % 2 ? 2 : -2) / (PI * h);
+                if (weight == 0.0f)
+                    continue;
+                // sin(2 PI h i / N) is a lookup into `sine_table` at (h * i) mod N
+                for (int i = 0; i < WAVETABLE_SIZE; i++)
+                    table[i] += weight * sine_table[(h * i) & (WAVETABLE_SIZE - 1)];
+            }
+            table[WAVETABLE_SIZE] = table[0];
+        }
+    }
+    wavetables_initialized = true;
 }
 
-/** A linked list representing a sound produced by the visualizer */
-typedef struct SoundList
+/** A sound requested by the visualizer, waiting to be started by the audio thread */
+typedef struct Note
 {
-    /** The waveform of the sound
-     * @param generic_parameter_name A float representing the number of waves plus the portion of a wave passed
-     * @returns A float representing the height of the wave at the time inputted
-     */
-    float (*waveform)(float);
+    /** The waveform of the sound */
+    Waveform waveform;
     /** The volume of the sound */
     float volume;
     /** The value of the array item represented by this sound to be converted into its frequency; should be between 0 and 1 */
     float value;
     /** The duration of the sound; how long it should sustain (in seconds) */
     float duration;
-    /** An internal variable whose initial value should be set to 0 representing the amound of time (in seconds) elapsed since the sound begun playing */
-    float elapsed;
-    /** An internal variable whose initial value should be set to 1 representing the portion of the sound's amplitude that should remain at this point */
-    float remaining_amplitude;
-    /** The next item in the linked list */
-    struct SoundList *next_item;
-} *SoundList;
-
-/** The linked list representing all currently active sounds */
-SoundList sound_list = NULL;
+    /** When the sound was requested (from `pacing_now`); it starts playing `audio_latency_ms` later. 0 to start it as soon as possible. */
+    uint64_t time;
+} Note;
+
+/** The most sounds that can ever play at once; every `VoiceBank` is allocated once with this many voices */
+#define AUDIO_MAX_VOICES 1024
+/** How many sounds may be waiting to be picked up by the audio thread */
+#define AUDIO_PENDING_SOUNDS (1 << 12)
+/** Number of samples mixed at a time; the block is kept on the stack */
+#define AUDIO_BLOCK_SIZE 256
+
+/**
+ * The sounds currently playing, stored as a structure of arrays so that voices can be mixed a whole block at a time with SIMD.
+ * Each voice is a phase accumulator reading from a wavetable, so no transcendental function is evaluated while mixing
+ * and the pitch doesn't drift however long the note is.
+ * Voice `i` is playing if `i < count`. The voices are kept in the order they started (finished or stolen voices are removed by moving the later ones down),
+ * so that the order they are mixed in, and thus the rounding of the mix, only depends on which voices are playing.
+ */
+typedef struct VoiceBank
+{
+    int count;
+    /** The band-limited wavetable (one of `wavetables`) of each voice */
+    const float *table[AUDIO_MAX_VOICES];
+    /** The position of each voice in its wave cycle, as a fraction of 2^32; wraps around at the end of every cycle */
+    uint32_t phase[AUDIO_MAX_VOICES];
+    /** How much `phase` advances by every sample; the frequency of the voice times 2^32 / `SAMPLE_RATE` */
+    uint32_t phase_step[AUDIO_MAX_VOICES];
+    /** The current amplitude of each voice (its volume times the portion of its amplitude that remains) */
+    float gain[AUDIO_MAX_VOICES];
+    /** How much `gain` decreases by every sample */
+    float gain_step[AUDIO_MAX_VOICES];
+    /** The number of samples of the next block before each voice starts (when it was started partway through the block) */
+    int delay[AUDIO_MAX_VOICES];
+} VoiceBank;
+
+/** The number of sounds that may play at once (at most `AUDIO_MAX_VOICES`); when exceeded, the voice closest to its end is stolen */
+int audio_polyphony = 256;
+
+/** The voices played by the audio stream
+ * @note Only touched by the audio thread
+ */
+VoiceBank live_voices;
+
+SPSC_RING_DEFINE(NoteRing, Note, AUDIO_PENDING_SOUNDS)
+
+/** Sounds pushed by the sort thread (the producer) that the audio thread (the consumer) hasn't started yet */
+NoteRing pending_notes;
+/** Number of sounds thrown away because `pending_notes` was full */
+size_t dropped_notes = 0;
+
+/**
+ * How long after it is requested a sound starts playing (in milliseconds).
+ * Sounds are placed in the audio stream at the sample matching their request time plus this delay, so they keep the rhythm of the accesses
+ * instead of starting together at the next audio buffer; it should be longer than the time between two audio callbacks.
+ */
+float audio_latency_ms = 50.f;
+
+/** The average time (in milliseconds) between the request of a sound and the sample it starts at in the audio stream
+ * @note Written by the audio thread only, and read by the render thread for display */
+_Atomic float audio_measured_latency_ms = 0.f;
+/** Number of sounds that started later than `audio_latency_ms` after their request, because the audio thread was late picking them up
+ * @note Written by the audio thread only, and read by the render thread for display */
+atomic_size_t late_notes = 0;
+
 /**
- * The mutex which should be locked when accessing or modifying `sound_list`
- * @see sound_list
+ * @brief Queues a new sound, requested at `time` (from `pacing_now`), to be played by the audio thread. Never allocates or blocks.
+ * @param waveform The waveform of the new sound
+ * @param volume The volume of the new sound
+ * @param value The value of the array item represented by the new sound to be converted into its frequency; should be between 0 and 1
+ * @param duration The duration (in seconds) of the new sound
+ * @note Must only be called from one thread, with nondecreasing times
  */
-pthread_mutex_t sound_list_mutex = PTHREAD_ERRORCHECK_MUTEX_INITIALIZER;
+void push_sound_at(Waveform waveform, float volume, float value, float duration, uint64_t time)
+{
+    if (!NoteRing_push(&pending_notes, (Note){waveform, volume, value, duration, time}))
+        dropped_notes++;
+}
+
+/** @brief Queues a new sound requested now, see `push_sound_at`. Must only be called from one thread (the sort thread). */
+void push_sound(Waveform waveform, float volume, float value, float duration)
+{
+    push_sound_at(waveform, volume, value, duration, pacing_now());
+}
+
+/** @return The band-limited wavetable of `waveform` for a fundamental of `wave_frequency` Hz */
+static const float *wavetable_for(Waveform waveform, float wave_frequency)
+{
+    int band = 0;
+    while (band < WAVETABLE_BANDS - 1 && wave_frequency > WAVETABLE_BASE_FREQUENCY * (1 << band))
+        band++;
+    return wavetables[waveform][band];
+}
+
+/** @return How much the phase of an oscillator of `wave_frequency` Hz advances by every sample */
+static inline uint32_t phase_step_for(float wave_frequency)
+{
+    return (uint32_t)(wave_frequency / SAMPLE_RATE * 4294967296.0);
+}
+
+/** @brief Moves voice `from` of `bank` to slot `to` */
+static inline void VoiceBank_move(VoiceBank *bank, int to, int from)
+{
+    bank->table[to] = bank->table[from];
+    bank->phase[to] = bank->phase[from];
+    bank->phase_step[to] = bank->phase_step[from];
+    bank->gain[to] = bank->gain[from];
+    bank->gain_step[to] = bank->gain_step[from];
+    bank->delay[to] = bank->delay[from];
+}
+
+/** @return The number of samples voice `i` of `bank` still plays for, counting those before it starts (a silent voice has none left) */
+static inline float VoiceBank_samples_left(const VoiceBank *bank, int i)
+{
+    return bank->gain[i] > 0.0f ? bank->delay[i] + bank->gain[i] / bank->gain_step[i] : 0.0f;
+}
 
 /**
- * @brief Pushes a new sound to the start of the `sound_list` linked list
- * @param waveform The waveform of the new sound. This will become the new sound's `waveform` property
- * @param volume The volume of the new sound. This will become the new sound's `volume` property
- * @param value The value of the array item represented by the new sound to be converted into its frequency; should be between 0 and 1. This will become the new sound's `value` property
- * @param duration The duration (in seconds) of the new sound. This will become the new sound's `duration` property
- * @see sound_list
- * @see SoundList
+ * @brief Starts playing `note` in `bank`, stealing the voice closest to its end when `polyphony` voices are already playing
+ * @param delay The number of samples into the next rendered block the note starts at
+ * @note Notes of the same duration end in the order they started, so the voices playing are then always the last `polyphony` notes started
+ * that aren't over, whatever was played before them; this is what lets the offline renderer start a segment from an empty bank
  */
-void push_sound(float (*waveform)(float), float volume, float value, float duration)
+void VoiceBank_start(VoiceBank *bank, Note note, int polyphony, int delay)
 {
-    pthread_mutex_lock(&sound_list_mutex); /*lock khfif juste pour assureee que other threads dont use the same resources and avoid bugs*/
-    SoundList new_item = &((struct SoundList){waveform, volume, value, duration, 0.0f, 1.0f, sound_list});
-    // new item data needs to be copied over to newly allocated memory because it will be overwritten next time this code is run, causing a circular reference
-    sound_list = MemAlloc(sizeof(struct SoundList));
-    memmove(sound_list, new_item, sizeof(struct SoundList));  /*moves the content of new_item to to the newly allocated memory li howa sound_list haka khir..*/
-    pthread_mutex_unlock(&sound_list_mutex);
+    if (bank->count >= polyphony)
+    {
+        // on ties, the first (oldest) voice is stolen
+        int stolen = 0;
+        for (int i = 1; i < bank->count; i++)
+            if (VoiceBank_samples_left(bank, i) < VoiceBank_samples_left(bank, stolen))
+                stolen = i;
+        bank->count--;
+        for (int i = stolen; i < bank->count; i++)
+            VoiceBank_move(bank, i, i + 1);
+    }
+    int slot = bank->count++;
+    float voice_frequency = frequency(note.value);
+    bank->table[slot] = wavetable_for(note.waveform, voice_frequency);
+    bank->phase[slot] = 0;
+    bank->phase_step[slot] = phase_step_for(voice_frequency);
+    bank->gain[slot] = note.volume;
+    bank->gain_step[slot] = note.volume / note.duration / SAMPLE_RATE;
+    bank->delay[slot] = delay;
 }
 
-/** Processes `sound_list` and generates the next audio sample */
-short next_sample()
+/** Number of frequency bins (per waveform) that dense notes are coalesced into */
+#define AUDIO_BINS 128
+/** Past this many notes starting in one block, the next ones are coalesced into `NoteBins` instead of getting a voice each */
+#define AUDIO_COALESCE_THRESHOLD 32
+/** The number of blocks a bin remembers the notes added to it for; longer notes are cut to this length */
+#define AUDIO_BIN_HISTORY 16
+
+/**
+ * One oscillator per waveform and frequency bin, for when notes come faster than voices can be given to them:
+ * however many notes start in a block, mixing costs at most one oscillator per bin.
+ * The notes of a bin lose their exact pitch (to within 1 / `AUDIO_BINS` of the range) and start sample, but keep their volume and decay:
+ * the amplitude of a bin is the sum of the envelopes of the notes added to it in the last `AUDIO_BIN_HISTORY` blocks,
+ * and its phase is a function of the sample being rendered, so what a bin plays never depends on older notes.
+ * Bin `b` of waveform `w` is oscillator `w * AUDIO_BINS + b`; the oscillators are always mixed in that order, so that the sum doesn't depend on
+ * when they started playing either.
+ */
+typedef struct NoteBins
+{
+    /** The number of blocks rendered so far */
+    uint64_t block;
+    /** The total volume of the notes added to each oscillator during block `block - age`, in slot `(block - age) % AUDIO_BIN_HISTORY` */
+    float volume[WAVEFORM_COUNT * AUDIO_BINS][AUDIO_BIN_HISTORY];
+    /** How much the amplitude of those notes decreases by every block */
+    float decay[WAVEFORM_COUNT * AUDIO_BINS][AUDIO_BIN_HISTORY];
+    const float *table[WAVEFORM_COUNT * AUDIO_BINS];
+    uint32_t phase_step[WAVEFORM_COUNT * AUDIO_BINS];
+    bool playing[WAVEFORM_COUNT * AUDIO_BINS];
+} NoteBins;
+
+/** @brief Adds `note` to its bin of `bins`; it starts at the beginning of the next rendered block */
+void NoteBins_add(NoteBins *bins, Note note)
 {
-    float accumulated_amplitude = 0.0f;
-    SoundList previous_item = NULL;
-    pthread_mutex_lock(&sound_list_mutex);
-    for (SoundList current_item = sound_list; current_item != NULL; current_item = current_item->next_item)
+    int bin = note.value <= 0.f ? 0 : note.value >= 1.f ? AUDIO_BINS - 1 : (int)(note.value * AUDIO_BINS);
+    int oscillator = note.waveform * AUDIO_BINS + bin;
+    if (!bins->playing[oscillator])
     {
-        accumulated_amplitude += current_item->waveform(frequency(current_item->value) * current_item->elapsed) * current_item->volume * current_item->remaining_amplitude;
+        float bin_frequency = frequency((bin + .5f) / AUDIO_BINS);
+        bins->table[oscillator] = wavetable_for(note.waveform, bin_frequency);
+        bins->phase_step[oscillator] = phase_step_for(bin_frequency);
+        bins->playing[oscillator] = true;
+    }
+    float blocks = ceilf(note.duration * SAMPLE_RATE / AUDIO_BLOCK_SIZE);
+    blocks = blocks < 1 ? 1 : blocks > AUDIO_BIN_HISTORY - 1 ? AUDIO_BIN_HISTORY - 1 : blocks;
+    int slot = bins->block % AUDIO_BIN_HISTORY;
+    bins->volume[oscillator][slot] += note.volume;
+    bins->decay[oscillator][slot] += note.volume / blocks;
+}
+
+/** The bins played by the audio stream when too many sounds start at once
+ * @note Only touched by the audio thread */
+NoteBins live_bins;
+/** Number of sounds that were coalesced into `live_bins` instead of getting a voice
+ * @note Unlike `live_bins`, also read by the render thread (for display); only written by the audio thread */
+atomic_size_t coalesced_notes = 0;
+
+/* If the audio callbacks drift further than this from the clock of the audio stream, the clock is reset instead of corrected gradually */
+#define AUDIO_CLOCK_RESYNC_NS 100000000LL
 
-        current_item->remaining_amplitude -= 1.0f / current_item->duration / SAMPLE_RATE;
+/** The number of samples of the audio stream rendered so far
+ * @note Only touched by the audio thread */
+uint64_t audio_stream_samples = 0;
+/** The time (from `pacing_now`) sample 0 of the audio stream is considered to have been rendered at; sample `s` is at `audio_stream_start + s / SAMPLE_RATE`
+ * @note Only touched by the audio thread */
+int64_t audio_stream_start = 0;
 
-        if (current_item->remaining_amplitude >= 0)
+/** @return The time (from `pacing_now`) of sample `sample` of the audio stream */
+static inline int64_t audio_sample_time(uint64_t sample)
+{
+    return audio_stream_start + (int64_t)(sample * 1000000000ULL / SAMPLE_RATE);
+}
+
+/**
+ * @brief Keeps `audio_stream_start` in line with the monotonic clock; called at the start of every audio callback
+ * @note Callbacks come at irregular times, so the clock of the stream follows them through a low-pass filter instead of jumping at every one
+ */
+void sync_audio_clock()
+{
+    int64_t now = pacing_now();
+    int64_t error = now - audio_sample_time(audio_stream_samples);
+    if (audio_stream_start == 0 || error > AUDIO_CLOCK_RESYNC_NS || error < -AUDIO_CLOCK_RESYNC_NS)
+        audio_stream_start += error;
+    else
+        audio_stream_start += error / 16;
+}
+
+/**
+ * @brief Moves the sounds of `pending_notes` that are due in the `num_samples` samples from `first_sample` of the audio stream into `live_voices`
+ * @note Past `AUDIO_COALESCE_THRESHOLD` sounds, the rest of the block's sounds go to `live_bins`, so a burst of accesses costs at most one oscillator per bin
+ */
+void start_pending_notes(uint64_t first_sample, int num_samples)
+{
+    int started = 0;
+    int polyphony = audio_polyphony < 1 ? 1 : audio_polyphony > AUDIO_MAX_VOICES ? AUDIO_MAX_VOICES : audio_polyphony;
+    int64_t latency = (int64_t)(audio_latency_ms * 1e6f), first_time = audio_sample_time(first_sample);
+    Note note;
+    while (NoteRing_peek(&pending_notes, &note))
+    {
+        int64_t delay = 0;
+        if (note.time != 0)
         {
-            current_item->elapsed += 1.0f / SAMPLE_RATE; //sample rate capable for example 1320hz or 44100hz ca depend wech drna 7na [dans notre cas, cest 44100!]
-            previous_item = current_item;
-            continue;
+            delay = (int64_t)note.time + latency - first_time;
+            delay = delay < 0 ? -1 : (int64_t)((uint64_t)delay * SAMPLE_RATE / 1000000000ULL);
+            if (delay >= num_samples)
+                break; // this note and the ones after it are due in a later block
+            if (delay < 0)
+            {
+                atomic_store_explicit(&late_notes, atomic_load_explicit(&late_notes, memory_order_relaxed) + 1, memory_order_relaxed);
+                delay = 0;
+            }
+            float latency_ms = (first_time - (int64_t)note.time) * 1e-6f + (float)delay * 1000 / SAMPLE_RATE;
+            float average_ms = atomic_load_explicit(&audio_measured_latency_ms, memory_order_relaxed);
+            atomic_store_explicit(&audio_measured_latency_ms, average_ms + (latency_ms - average_ms) / 256, memory_order_relaxed);
+        }
+        NoteRing_pop(&pending_notes, &note);
+        if (started++ < AUDIO_COALESCE_THRESHOLD)
+            VoiceBank_start(&live_voices, note, polyphony, delay);
+        else
+        {
+            NoteBins_add(&live_bins, note);
+            atomic_store_explicit(&coalesced_notes, atomic_load_explicit(&coalesced_notes, memory_order_relaxed) + 1, memory_order_relaxed);
         }
+    }
+}
+
+/* The mixer works on `MIX_LANES` consecutive samples of one voice at a time */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MIX_LANES 8
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MIX_LANES 4
+#else
+#define MIX_LANES 1
+#endif
+
+/* A phase is split into a wavetable index (its top `WAVETABLE_BITS` bits) and a position between two samples (the other bits) */
+#define PHASE_FRACTION_BITS (32 - WAVETABLE_BITS)
+#define PHASE_FRACTION_MASK ((1u << PHASE_FRACTION_BITS) - 1)
+#define PHASE_FRACTION_SCALE (1.0f / (1u << PHASE_FRACTION_BITS))
 
-        // delete the current item from sound_list
+/** Linearly interpolated lookup of `table` at `phase` */
+static inline float wavetable_lookup(const float *table, uint32_t phase)
+{
+    uint32_t index = phase >> PHASE_FRACTION_BITS;
+    float t = (phase & PHASE_FRACTION_MASK) * PHASE_FRACTION_SCALE;
+    return table[index] + (table[index + 1] - table[index]) * t;
+}
 
-        SoundList sound_to_replace = current_item->next_item;
-        MemFree(current_item);
-        if (previous_item == NULL) // there is no previous item therefore i == sound_list
-            sound_list = sound_to_replace;
+/**
+ * @brief Adds `num_samples` samples of one voice to `out`
+ * @param phase The phase of the first sample; every following sample is `phase_step` further
+ * @param gain The amplitude of the first sample; it decreases by `gain_step` every sample and stops at 0
+ */
+void mix_voice(const float *table, uint32_t phase, uint32_t phase_step, float gain, float gain_step, float *out, int num_samples)
+{
+    int i = 0;
+#if MIX_LANES == 8
+    const __m256 lane_offsets = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i phases = _mm256_add_epi32(_mm256_set1_epi32(phase), _mm256_mullo_epi32(_mm256_set1_epi32(phase_step), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    const __m256i phases_step = _mm256_set1_epi32(phase_step * 8);
+    for (; i + 8 <= num_samples; i += 8)
+    {
+        __m256i index = _mm256_srli_epi32(phases, PHASE_FRACTION_BITS);
+        __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(phases, _mm256_set1_epi32(PHASE_FRACTION_MASK))), _mm256_set1_ps(PHASE_FRACTION_SCALE));
+        __m256 a = _mm256_i32gather_ps(table, index, 4);
+        __m256 b = _mm256_i32gather_ps(table + 1, index, 4);
+        __m256 wave = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t));
+        __m256 k = _mm256_add_ps(_mm256_set1_ps((float)i), lane_offsets);
+        __m256 amplitude = _mm256_max_ps(_mm256_sub_ps(_mm256_set1_ps(gain), _mm256_mul_ps(k, _mm256_set1_ps(gain_step))), _mm256_setzero_ps());
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(wave, amplitude)));
+        phases = _mm256_add_epi32(phases, phases_step);
+    }
+    phase += (uint32_t)i * phase_step;
+#elif MIX_LANES == 4
+    // SSE2 has no gather, so the two samples around each phase are loaded one lane at a time
+    const __m128 lane_offsets = _mm_setr_ps(0, 1, 2, 3);
+    for (; i + 4 <= num_samples; i += 4)
+    {
+        float a[4], b[4], t[4];
+        for (int lane = 0; lane < 4; lane++, phase += phase_step)
+        {
+            uint32_t index = phase >> PHASE_FRACTION_BITS;
+            a[lane] = table[index];
+            b[lane] = table[index + 1];
+            t[lane] = (phase & PHASE_FRACTION_MASK) * PHASE_FRACTION_SCALE;
+        }
+        __m128 va = _mm_loadu_ps(a);
+        __m128 wave = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b), va), _mm_loadu_ps(t)));
+        __m128 k = _mm_add_ps(_mm_set1_ps((float)i), lane_offsets);
+        __m128 amplitude = _mm_max_ps(_mm_sub_ps(_mm_set1_ps(gain), _mm_mul_ps(k, _mm_set1_ps(gain_step))), _mm_setzero_ps());
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(wave, amplitude)));
+    }
+#endif
+    for (; i < num_samples; i++, phase += phase_step)
+    {
+        float amplitude = gain - i * gain_step;
+        if (amplitude < 0.0f)
+            amplitude = 0.0f;
+        out[i] += wavetable_lookup(table, phase) * amplitude;
+    }
+}
+
+/**
+ * @brief Mixes the next `num_samples` samples of every voice of `bank` into `out` (overwriting it) and advances the voices
+ * @param num_samples At most `AUDIO_BLOCK_SIZE`
+ */
+void VoiceBank_render(VoiceBank *bank, float *out, int num_samples)
+{
+    memset(out, 0, num_samples * sizeof(float));
+    int kept = 0;
+    for (int i = 0; i < bank->count; i++)
+    {
+        int delay = bank->delay[i];
+        if (delay >= num_samples)
+            bank->delay[i] -= num_samples;
         else
-            previous_item->next_item = sound_to_replace;
-        current_item = &(struct SoundList){.next_item = sound_to_replace}; // on the next iteration i becomes sound_to_replace
+        {
+            bank->delay[i] = 0;
+            int played = num_samples - delay;
+            mix_voice(bank->table[i], bank->phase[i], bank->phase_step[i], bank->gain[i], bank->gain_step[i], out + delay, played);
+            bank->phase[i] += (uint32_t)played * bank->phase_step[i]; //sample rate capable for example 1320hz or 44100hz ca depend wech drna 7na [dans notre cas, cest 44100!]
+            bank->gain[i] -= played * bank->gain_step[i];
+            if (bank->gain[i] <= 0.0f)
+                continue; // the sound is over
+        }
+        // the voices still playing move down over the finished ones, keeping their order
+        if (kept != i)
+            VoiceBank_move(bank, kept, i);
+        kept++;
+    }
+    bank->count = kept;
+}
+
+/**
+ * @brief Adds the next `num_samples` samples of every bin of `bins` to `out` and advances the bins by one block
+ * @param first_sample The position of the first of these samples in the stream, which sets the phase of the oscillators
+ * @param num_samples At most `AUDIO_BLOCK_SIZE`
+ */
+void NoteBins_render(NoteBins *bins, uint64_t first_sample, float *out, int num_samples)
+{
+    int current = bins->block % AUDIO_BIN_HISTORY;
+    int next = (bins->block + 1) % AUDIO_BIN_HISTORY;
+    for (int b = 0; b < WAVEFORM_COUNT * AUDIO_BINS; b++)
+    {
+        if (!bins->playing[b])
+            continue;
+        // the amplitude goes linearly from the sum of the envelopes at the start of the block to their sum at the start of the next one
+        float start = 0.0f, end = 0.0f;
+        for (int slot = 0; slot < AUDIO_BIN_HISTORY; slot++)
+        {
+            int age = (current - slot + AUDIO_BIN_HISTORY) % AUDIO_BIN_HISTORY;
+            start += fmaxf(bins->volume[b][slot] - age * bins->decay[b][slot], 0.0f);
+            end += fmaxf(bins->volume[b][slot] - (age + 1) * bins->decay[b][slot], 0.0f);
+        }
+        mix_voice(bins->table[b], (uint32_t)first_sample * bins->phase_step[b], bins->phase_step[b], start, (start - end) / num_samples, out, num_samples);
+        if (end > 0.0f)
+        {
+            // the slot of the next block last held notes `AUDIO_BIN_HISTORY` blocks old, which are over
+            bins->volume[b][next] = 0.0f;
+            bins->decay[b][next] = 0.0f;
+            continue;
+        }
+        // every note of the bin is over
+        memset(bins->volume[b], 0, sizeof(bins->volume[b]));
+        memset(bins->decay[b], 0, sizeof(bins->decay[b]));
+        bins->playing[b] = false;
     }
-    pthread_mutex_unlock(&sound_list_mutex);
-    
-    //This line scales the calculated accumulated_amplitude value to a suitable range for audio sample representation, typically a 16-bit signed integer format. hka bach tkon within the audio playback system.
-    return accumulated_amplitude >= 1 ? 32767 : accumulated_amplitude < -1 ? -32768
-                                                                           : accumulated_amplitude * 32768.0f;
+    bins->block++;
+}
+
+/** Converts mixed samples to 16-bit samples, clipping whatever is outside of [-1, 1] */
+void convert_samples(const float *in, short *out, int num_samples)
+{
+    int i = 0;
+#if MIX_LANES > 1
+    for (; i + 8 <= num_samples; i += 8)
+    {
+        __m128 low = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i), _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+        __m128 high = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i + 4), _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+        // the saturating pack turns the scaled 1.0 (32768) into 32767
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(low, _mm_set1_ps(32768.0f))), _mm_cvtps_epi32(_mm_mul_ps(high, _mm_set1_ps(32768.0f))));
+        _mm_storeu_si128((__m128i *)(out + i), packed);
+    }
+#endif
+    //This line scales the calculated amplitude value to a suitable range for audio sample representation, typically a 16-bit signed integer format. hka bach tkon within the audio playback system.
+    for (; i < num_samples; i++)
+        out[i] = in[i] >= 1 ? 32767 : in[i] < -1 ? -32768
+                                                 : in[i] * 32768.0f;
 }
 
 /** Upon audio initialization, this function will be passed into the `SetAudioStreamCallback` function, wech m3natha?: win ma ye7tage el system audio data it fills the buffer with audio samples..  cest invokee par le system audio, meaning the audio system gives it it's own paramaters.*/
 void audio_callback(void *buffer, unsigned int num_samples)
 {
-    for (unsigned int i = 0; i < num_samples; i++)
-        ((short *)buffer)[i] = next_sample();
+    sync_audio_clock();
+    float block[AUDIO_BLOCK_SIZE];
+    for (unsigned int done = 0; done < num_samples; done += AUDIO_BLOCK_SIZE)
+    {
+        int block_size = num_samples - done < AUDIO_BLOCK_SIZE ? num_samples - done : AUDIO_BLOCK_SIZE;
+        start_pending_notes(audio_stream_samples + done, block_size);
+        VoiceBank_render(&live_voices, block, block_size);
+        NoteBins_render(&live_bins, audio_stream_samples + done, block, block_size);
+        convert_samples(block, (short *)buffer + done, block_size);
+    }
+    audio_stream_samples += num_samples;
 }
 
 /** The audio stream to stream procedurally generated audio */
@@ -136,6 +550,7 @@ AudioStream audio_stream;
 /** Initializes Raylib Sorting Visualizer's procedural audio (it is expected that InitAudioDevice is called first) */
 void initialize_procedural_audio()
 {
+    initialize_wavetables();
     audio_stream = LoadAudioStream(SAMPLE_RATE, 16, 1); //notre SAMPLE_RATE = 44100, 16:representing 16bit audio, 1: audio channel MONO
     SetAudioStreamCallback(audio_stream, audio_callback);
     PlayAudioStream(audio_stream);
@@ -0,0 +1,83 @@
+#include "raylib.h"
+#include <stdlib.h>
+#include "Array.c"
+#include "pacing.c"
+#include "trace.c"
+#include "algorithms/shuffle/StandardShuffle.c"
+#include "algorithms/sort/SelectionSort.c"
+
+/*
+ * Headless recorder of access traces (see `trace.c`).
+ * Shuffles a sorted array and sorts it again at full speed, recording every access to a trace file.
+ * The sort is also run once without recording, to report the overhead of recording.
+ *
+ * Usage: RaylibSortingVisualizerRecord <output file> [size] [seed]
+ */
+
+/** The algorithm that shuffles the array, and the one that sorts it */
+Algorithm *RECORD_SHUFFLE = &StandardShuffle;
+Algorithm *RECORD_SORT = &SelectionSort;
+
+/** @return The number of seconds `algorithm` takes to run on a copy of `input` without recording, or a negative value if it returned `false` */
+double record_time_unrecorded(Algorithm *algorithm, Array input)
+{
+    Array work = Array_copy(input);
+    uint64_t start = pacing_now();
+    bool ok = algorithm->fun(work);
+    uint64_t end = pacing_now();
+    Array_free(work);
+    return ok ? (end - start) * 1e-9 : -1.0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <output file> [size] [seed]\n", argv[0]);
+        return 1;
+    }
+    const char *path = argv[1];
+    size_t size = argc > 2 ? strtoull(argv[2], NULL, 10) : 4096;
+    unsigned int seed = argc > 3 ? strtoul(argv[3], NULL, 10) : 0;
+
+    Array array = Array_new_init(size);
+    if (array == NULL)
+    {
+        fprintf(stderr, "Record: could not make a %llu-element array\n", (unsigned long long)size);
+        return 1;
+    }
+    // the same run without recording, for comparison
+    Array shuffled = Array_copy(array);
+    SetRandomSeed(seed);
+    bool ok = RECORD_SHUFFLE->fun(shuffled);
+    double unrecorded = ok ? record_time_unrecorded(RECORD_SORT, shuffled) : -1.0;
+    Array_free(shuffled);
+
+    TraceRecorder recorder;
+    if (!TraceRecorder_open(&recorder, path, array))
+    {
+        fprintf(stderr, "Record: could not open %s\n", path);
+        return 1;
+    }
+    Array_observe(array, TraceRecorder_observer(&recorder));
+    SetRandomSeed(seed);
+    ok = ok && unrecorded >= 0.0 && RECORD_SHUFFLE->fun(array);
+    uint64_t sort_first_event = TraceRecorder_event_count(&recorder);
+    uint64_t start = pacing_now();
+    ok = ok && RECORD_SORT->fun(array);
+    double recorded = (pacing_now() - start) * 1e-9;
+    Array_unobserve(array, &recorder);
+    uint64_t event_count = TraceRecorder_event_count(&recorder), sort_events = event_count - sort_first_event;
+    if (!TraceRecorder_close(&recorder) || !ok)
+    {
+        fprintf(stderr, "Record: %s\n", ok ? "could not write the trace" : "the algorithms returned false");
+        return 1;
+    }
+    uint64_t bytes = recorder.file_offset + recorder.index_count * sizeof(TraceIndexEntry);
+    Array_free(array);
+
+    printf("%s: %llu items, %llu events (%llu sorting), %.2f bytes per event\n",
+           path, (unsigned long long)size, (unsigned long long)event_count, (unsigned long long)sort_events, (double)bytes / event_count);
+    printf("%s: %.3fs recorded, %.3fs unrecorded (%.2fx)\n", RECORD_SORT->name, recorded, unrecorded, recorded / unrecorded);
+    return 0;
+}
@@ -0,0 +1,270 @@
+#include "raylib.h"
+#include <stdlib.h>
+#include <pthread.h>
+#include "Array.c"
+#include "procedural_audio.c"
+#include "trace_replay.c"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+/*
+ * Offline audio renderer: plays an access trace (see `trace.c`) through the procedural audio mixer and writes the mix to a WAV file
+ * as fast as the CPU allows, instead of in real time through the audio device.
+ *
+ * Usage: RaylibSortingVisualizerRenderAudio <trace file> <output file> [seconds] [16|float] [threads]
+ *
+ * The whole run is fit into `seconds` seconds of audio, like the video renderer does, so the two can be muxed together.
+ * Every access starts a note at the exact sample its (scaled) timestamp falls on, with the waveform, pitch and volume the visualizer would give it;
+ * as in the visualizer, when more than `AUDIO_COALESCE_THRESHOLD` notes fall in one block the rest are mixed through frequency bins (see `NoteBins`).
+ *
+ * The output is split into one contiguous segment per thread. A voice lasts `SOUND_SUSTAIN` seconds, so the voices playing at the start
+ * of a segment are rebuilt by mixing (and throwing away) the `AUDIO_HANDOFF_SECONDS` before it; each thread then writes its
+ * segment at its place in the file. The voices playing only depend on the notes of the last `SOUND_SUSTAIN` seconds (see `VoiceBank_start`)
+ * and are mixed in the order they started, so the file is the same whatever the number of threads (`make check-render-audio` checks it).
+ */
+
+/* How long the sound lasts when an array access is made; the same as the visualizer */
+#define SOUND_SUSTAIN 0.05f
+/** How much audio before a segment is mixed to hand the voices over from the previous segment */
+#define AUDIO_HANDOFF_SECONDS (2 * SOUND_SUSTAIN)
+/** The number of samples each thread converts and writes at a time */
+#define AUDIO_WRITE_SAMPLES (1 << 16)
+#define WAV_HEADER_SIZE 58
+
+/** The settings of a render, shared by every worker */
+typedef struct AudioJob
+{
+    Trace trace;
+    const char *path;
+    bool float_samples;
+    /** The number of samples of the output */
+    uint64_t sample_count;
+    /** Recorded nanoseconds per sample of output */
+    double ns_per_sample;
+    /** The volume of every note, from the average delay between accesses in the output */
+    float volume;
+} AudioJob;
+
+/** The state of one worker thread, which renders the samples [`first`, `end`) */
+typedef struct AudioWorker
+{
+    AudioJob *job;
+    pthread_t thread;
+    uint64_t first;
+    uint64_t end;
+    bool failed;
+    Array array;
+    TraceReplay replay;
+    VoiceBank voices;
+    NoteBins bins;
+} AudioWorker;
+
+/**
+ * @brief Starts the notes of the accesses that fall in the block starting at sample `block` (of `block_size` samples)
+ * @note Like in the visualizer, the first `AUDIO_COALESCE_THRESHOLD` notes of a block get a voice and the others are coalesced into `bins`
+ */
+void AudioWorker_start_notes(AudioWorker *worker, uint64_t block, int block_size)
+{
+    AudioJob *job = worker->job;
+    int polyphony = audio_polyphony < 1 ? 1 : audio_polyphony > AUDIO_MAX_VOICES ? AUDIO_MAX_VOICES : audio_polyphony;
+    int started = 0;
+    uint64_t end_ns = (uint64_t)ceil((block + block_size) * job->ns_per_sample);
+    float len = job->trace.header.array_len;
+    TraceEvent event;
+    while (TraceReplay_has_next(&worker->replay) && worker->replay.next.time_ns < end_ns)
+    {
+        TraceReplay_step(&worker->replay, &event);
+        Note note = {event.kind == TRACE_READ ? WAVEFORM_SINE : WAVEFORM_TRIANGLE, job->volume, event.value / len, SOUND_SUSTAIN};
+        if (started++ >= AUDIO_COALESCE_THRESHOLD)
+        {
+            NoteBins_add(&worker->bins, note);
+            continue;
+        }
+        int64_t delay = (int64_t)(event.time_ns / job->ns_per_sample) - (int64_t)block;
+        VoiceBank_start(&worker->voices, note, polyphony, delay < 0 ? 0 : delay >= block_size ? block_size - 1 : delay);
+    }
+}
+
+/** @brief The worker threads: mix the handoff before their segment, then mix their segment and write it into the file */
+void *audio_worker_proc(void *args)
+{
+    AudioWorker *worker = args;
+    AudioJob *job = worker->job;
+    int sample_size = job->float_samples ? sizeof(float) : sizeof(short);
+    FILE *file = fopen(job->path, "r+b");
+    float *mix = MemAlloc(AUDIO_WRITE_SAMPLES * sizeof(float));
+    short *converted = MemAlloc(AUDIO_WRITE_SAMPLES * sizeof(short));
+    if (file == NULL || fseek(file, WAV_HEADER_SIZE + worker->first * sample_size, SEEK_SET) != 0)
+        worker->failed = true;
+
+    // blocks are aligned to the start of the output so that every segment splits the audio into the same blocks as a single thread would
+    uint64_t handoff = (uint64_t)(AUDIO_HANDOFF_SECONDS * SAMPLE_RATE + AUDIO_BLOCK_SIZE - 1) / AUDIO_BLOCK_SIZE * AUDIO_BLOCK_SIZE;
+    uint64_t position = worker->first > handoff ? worker->first - handoff : 0;
+    uint64_t first_ns = (uint64_t)ceil(position * job->ns_per_sample);
+    if (first_ns == 0)
+        TraceReplay_seek(&worker->replay, 0);
+    else
+        TraceReplay_seek_time(&worker->replay, first_ns - 1);
+    // the bins sum their notes in the order of their slots, which must be the same in every segment
+    worker->bins.block = position / AUDIO_BLOCK_SIZE;
+    float block[AUDIO_BLOCK_SIZE];
+    for (; position < worker->first; position += AUDIO_BLOCK_SIZE)
+    {
+        AudioWorker_start_notes(worker, position, AUDIO_BLOCK_SIZE);
+        VoiceBank_render(&worker->voices, block, AUDIO_BLOCK_SIZE);
+        NoteBins_render(&worker->bins, position, block, AUDIO_BLOCK_SIZE);
+    }
+
+    while (!worker->failed && position < worker->end)
+    {
+        int chunk = worker->end - position < AUDIO_WRITE_SAMPLES ? worker->end - position : AUDIO_WRITE_SAMPLES;
+        for (int done = 0; done < chunk; done += AUDIO_BLOCK_SIZE)
+        {
+            int block_size = chunk - done < AUDIO_BLOCK_SIZE ? chunk - done : AUDIO_BLOCK_SIZE;
+            AudioWorker_start_notes(worker, position + done, block_size);
+            VoiceBank_render(&worker->voices, mix + done, block_size);
+            NoteBins_render(&worker->bins, position + done, mix + done, block_size);
+        }
+        const void *samples = mix;
+        if (!job->float_samples)
+        {
+            convert_samples(mix, converted, chunk);
+            samples = converted;
+        }
+        worker->failed = fwrite(samples, sample_size, chunk, file) != (size_t)chunk;
+        position += chunk;
+    }
+    if (file != NULL && fclose(file) != 0)
+        worker->failed = true;
+    MemFree(mix);
+    MemFree(converted);
+    return NULL;
+}
+
+static void wav_put_u16(unsigned char **out, uint16_t value)
+{
+    *(*out)++ = value;
+    *(*out)++ = value >> 8;
+}
+
+static void wav_put_u32(unsigned char **out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        *(*out)++ = value >> (8 * i);
+}
+
+/** @brief Writes the `WAV_HEADER_SIZE`-byte header of a mono `SAMPLE_RATE` WAV file of `sample_count` samples to `file` */
+bool wav_write_header(FILE *file, uint64_t sample_count, bool float_samples)
+{
+    int sample_size = float_samples ? 4 : 2;
+    unsigned char header[WAV_HEADER_SIZE], *out = header;
+    memcpy(out, "RIFF", 4);
+    out += 4;
+    wav_put_u32(&out, WAV_HEADER_SIZE - 8 + sample_count * sample_size);
+    memcpy(out, "WAVEfmt ", 8);
+    out += 8;
+    wav_put_u32(&out, 18);
+    wav_put_u16(&out, float_samples ? 3 : 1); // IEEE float, or PCM
+    wav_put_u16(&out, 1);
+    wav_put_u32(&out, SAMPLE_RATE);
+    wav_put_u32(&out, SAMPLE_RATE * sample_size);
+    wav_put_u16(&out, sample_size);
+    wav_put_u16(&out, 8 * sample_size);
+    wav_put_u16(&out, 0);
+    memcpy(out, "fact", 4);
+    out += 4;
+    wav_put_u32(&out, 4);
+    wav_put_u32(&out, sample_count);
+    memcpy(out, "data", 4);
+    out += 4;
+    wav_put_u32(&out, sample_count * sample_size);
+    return fwrite(header, 1, WAV_HEADER_SIZE, file) == WAV_HEADER_SIZE;
+}
+
+/** @return The number of processors, to start as many workers */
+int audio_processor_count()
+{
+#ifdef _WIN32
+    const char *count = getenv("NUMBER_OF_PROCESSORS");
+    return count != NULL && atoi(count) > 0 ? atoi(count) : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? count : 1;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s <trace file> <output file> [seconds] [16|float] [threads]\n", argv[0]);
+        return 1;
+    }
+    static AudioJob job;
+    if (!Trace_open(&job.trace, argv[1]))
+    {
+        fprintf(stderr, "Render: could not open trace %s\n", argv[1]);
+        return 1;
+    }
+    job.path = argv[2];
+    double seconds = argc > 3 ? atof(argv[3]) : 60.0;
+    job.float_samples = argc > 4 && strcmp(argv[4], "float") == 0;
+    int thread_count = argc > 5 ? atoi(argv[5]) : audio_processor_count();
+    job.sample_count = (uint64_t)(seconds * SAMPLE_RATE);
+    if (job.sample_count == 0 || thread_count < 1 || job.trace.header.array_len == 0 ||
+        job.sample_count * (job.float_samples ? 4 : 2) > UINT32_MAX - WAV_HEADER_SIZE)
+    {
+        fprintf(stderr, "Render: invalid settings\n");
+        return 1;
+    }
+    job.ns_per_sample = job.trace.header.duration_ns > 0 ? (double)job.trace.header.duration_ns / job.sample_count : 1.0;
+    // the visualizer gives a note the volume `delay / 500 / SOUND_SUSTAIN`, for a delay of `delay` milliseconds per access
+    float delay = job.trace.header.event_count > 0 ? seconds * 1000.0 / job.trace.header.event_count : 0.f;
+    job.volume = delay / 500 / SOUND_SUSTAIN;
+    initialize_wavetables();
+
+    FILE *file = fopen(job.path, "wb");
+    bool ok = file != NULL && wav_write_header(file, job.sample_count, job.float_samples);
+    if (file != NULL)
+        ok &= fclose(file) == 0;
+    if (!ok)
+    {
+        fprintf(stderr, "Render: could not write %s\n", job.path);
+        return 1;
+    }
+
+    // segments are whole blocks, so that they are mixed in the same blocks as by a single thread
+    uint64_t block_count = (job.sample_count + AUDIO_BLOCK_SIZE - 1) / AUDIO_BLOCK_SIZE;
+    if ((uint64_t)thread_count > block_count)
+        thread_count = block_count;
+    AudioWorker *workers = MemAlloc(thread_count * sizeof(AudioWorker));
+    uint64_t start = pacing_now();
+    for (int i = 0; i < thread_count; i++)
+    {
+        AudioWorker *worker = &workers[i];
+        *worker = (AudioWorker){&job};
+        worker->first = block_count * i / thread_count * AUDIO_BLOCK_SIZE;
+        worker->end = i + 1 < thread_count ? block_count * (i + 1) / thread_count * AUDIO_BLOCK_SIZE : job.sample_count;
+        worker->array = Array_new(job.trace.header.array_len);
+        TraceReplay_init(&worker->replay, &job.trace, worker->array);
+        pthread_create(&worker->thread, NULL, audio_worker_proc, worker);
+    }
+    for (int i = 0; i < thread_count; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        ok &= !workers[i].failed;
+        Array_free(workers[i].array);
+    }
+    double elapsed = (pacing_now() - start) * 1e-9;
+    MemFree(workers);
+    Trace_close(&job.trace);
+    if (!ok)
+    {
+        fprintf(stderr, "Render: could not write %s\n", job.path);
+        return 1;
+    }
+    fprintf(stderr, "%s: %.2fs of audio in %.2fs (%.1fx real time, %d threads)\n", job.path, seconds, elapsed, seconds / elapsed, thread_count);
+    return 0;
+}
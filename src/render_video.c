@@ -0,0 +1,316 @@
+#include "raylib.h"
+#include <stdlib.h>
+#include <pthread.h>
+#include "Array.c"
+#include "bar_raster.c"
+#include "column_summary.c"
+#include "trace_replay.c"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+
+/*
+ * Headless video renderer: plays an access trace (see `trace.c`) at a fixed frame rate and writes the frames as a raw video,
+ * drawn on the CPU with the same bars and heat colors as the visualizer. No window or GPU is used.
+ *
+ * Usage: RaylibSortingVisualizerRender <trace file> <output file, or - for stdout> [seconds] [width] [height] [fps] [threads]
+ *
+ * The output is YUV4MPEG2 (4:4:4) when the output file name ends in `.y4m`, and a stream of binary PPM images otherwise
+ * (both can be piped into `ffmpeg`, the latter with `-f image2pipe`). The whole run is fit into `seconds` seconds of video.
+ *
+ * Frames are rendered in batches of `VIDEO_FRAMES_PER_BATCH` consecutive frames, claimed by the worker threads in order.
+ * A worker seeks to a little before its batch (the time it takes an access to cool down), replays the events from there
+ * to rebuild the heat of the bars, renders its frames, and writes them once every earlier batch has been written.
+ */
+
+/* What portion of the original color will remain 1 second after an array access; the same as the visualizer */
+#define COLOR_SUSTAIN 1e-1
+#define VIDEO_FRAMES_PER_BATCH 8
+/** The access time of the items no event reached yet; long enough ago to have no heat */
+#define VIDEO_NEVER -1e9f
+
+/** The settings of a render, shared by every worker */
+typedef struct VideoJob
+{
+    Trace trace;
+    HeatPalette palette;
+    int width;
+    int height;
+    int fps;
+    int frame_count;
+    /** Recorded nanoseconds per second of video */
+    double speed;
+    /** How long (in seconds of video) an access stays visible */
+    float lookback;
+    bool y4m;
+    FILE *output;
+    size_t frame_size;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t written;
+    /** The next batch to be claimed by a worker, and the next one to be written */
+    int next_batch;
+    int next_written;
+    bool write_failed;
+} VideoJob;
+
+/** The state of one worker thread */
+typedef struct VideoWorker
+{
+    VideoJob *job;
+    pthread_t thread;
+    Array array;
+    TraceReplay replay;
+    /** The time (in seconds of video) of the last read and write of each item */
+    float *reads;
+    float *writes;
+    /** Used when there are more items than pixel columns */
+    ColumnSummary summary;
+    /** Used otherwise */
+    HeatBuffers heat;
+    BarCanvas canvas;
+    /** The encoded frames of the batch being rendered */
+    unsigned char *frames;
+} VideoWorker;
+
+/** @brief Writes the pixels of `canvas` (over a black background) to `out` as a Y4M frame or a PPM image */
+void video_encode_frame(const BarCanvas *canvas, bool y4m, unsigned char *out)
+{
+    size_t pixel_count = (size_t)canvas->width * canvas->height;
+    if (y4m)
+    {
+        memcpy(out, "FRAME\n", 6);
+        unsigned char *y = out + 6, *u = y + pixel_count, *v = u + pixel_count;
+        for (size_t i = 0; i < pixel_count; i++)
+        {
+            Color pixel = canvas->pixels[i];
+            int r = pixel.r * pixel.a / 255, g = pixel.g * pixel.a / 255, b = pixel.b * pixel.a / 255;
+            // BT.601, limited range
+            y[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+            u[i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+            v[i] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+        }
+    }
+    else
+    {
+        int header_size = sprintf((char *)out, "P6\n%d %d\n255\n", canvas->width, canvas->height);
+        unsigned char *rgb = out + header_size;
+        for (size_t i = 0; i < pixel_count; i++)
+        {
+            Color pixel = canvas->pixels[i];
+            rgb[3 * i] = pixel.r * pixel.a / 255;
+            rgb[3 * i + 1] = pixel.g * pixel.a / 255;
+            rgb[3 * i + 2] = pixel.b * pixel.a / 255;
+        }
+    }
+}
+
+/** @brief Applies the events up to recorded time `time_ns` to the array and the heat of `worker` */
+void VideoWorker_advance(VideoWorker *worker, uint64_t time_ns)
+{
+    VideoJob *job = worker->job;
+    bool summarized = worker->summary.len != 0;
+    TraceEvent event;
+    while (TraceReplay_has_next(&worker->replay) && worker->replay.next.time_ns <= time_ns)
+    {
+        TraceReplay_step(&worker->replay, &event);
+        float time = event.time_ns / job->speed;
+        if (event.kind == TRACE_READ)
+        {
+            worker->reads[event.index] = time;
+            if (summarized)
+                ColumnSummary_read(&worker->summary, event.index, time);
+        }
+        else
+        {
+            worker->writes[event.index] = time;
+            if (summarized)
+                ColumnSummary_write(&worker->summary, event.index, event.value, time);
+        }
+    }
+}
+
+/** @brief Renders the frames of batch `batch` into `worker->frames` */
+void VideoWorker_render_batch(VideoWorker *worker, int batch)
+{
+    VideoJob *job = worker->job;
+    size_t len = job->trace.header.array_len;
+    int first = batch * VIDEO_FRAMES_PER_BATCH;
+    float start = (float)first / job->fps - job->lookback;
+    TraceReplay_seek_time(&worker->replay, start > 0.f ? (uint64_t)(start * job->speed) : 0);
+    for (size_t i = 0; i < len; i++)
+        worker->reads[i] = worker->writes[i] = VIDEO_NEVER;
+    if (len > (size_t)job->width)
+    {
+        ColumnSummary_reset(&worker->summary, worker->array->_arr, len, job->width);
+        for (int column = 0; column < job->width; column++)
+            worker->summary.last_read[column] = worker->summary.last_write[column] = VIDEO_NEVER;
+    }
+
+    for (int frame = first; frame < first + VIDEO_FRAMES_PER_BATCH && frame < job->frame_count; frame++)
+    {
+        float now = (float)frame / job->fps;
+        VideoWorker_advance(worker, (uint64_t)(now * job->speed));
+        BarCanvas_clear(&worker->canvas);
+        if (len > (size_t)job->width)
+        {
+            ColumnSummary_refresh(&worker->summary);
+            BarCanvas_set_summary(&worker->canvas, &job->palette, &worker->summary, now);
+        }
+        else
+        {
+            HeatBuffers_update(&worker->heat, &job->palette, worker->reads, worker->writes, len, now);
+            BarCanvas_set_bars(&worker->canvas, &job->palette, &worker->heat, worker->array->_arr, len);
+        }
+        BarCanvas_rasterize(&worker->canvas, BLACK);
+        video_encode_frame(&worker->canvas, job->y4m, worker->frames + (frame - first) * job->frame_size);
+    }
+}
+
+/** @brief The worker threads: claim batches in order, render them, and write them in order */
+void *video_worker_proc(void *args)
+{
+    VideoWorker *worker = args;
+    VideoJob *job = worker->job;
+    int batch_count = (job->frame_count + VIDEO_FRAMES_PER_BATCH - 1) / VIDEO_FRAMES_PER_BATCH;
+    while (true)
+    {
+        pthread_mutex_lock(&job->mutex);
+        int batch = job->next_batch++;
+        pthread_mutex_unlock(&job->mutex);
+        if (batch >= batch_count)
+            break;
+
+        VideoWorker_render_batch(worker, batch);
+        int frames = job->frame_count - batch * VIDEO_FRAMES_PER_BATCH < VIDEO_FRAMES_PER_BATCH ? job->frame_count - batch * VIDEO_FRAMES_PER_BATCH : VIDEO_FRAMES_PER_BATCH;
+
+        pthread_mutex_lock(&job->mutex);
+        while (job->next_written != batch)
+            pthread_cond_wait(&job->written, &job->mutex);
+        pthread_mutex_unlock(&job->mutex);
+        bool ok = fwrite(worker->frames, job->frame_size, frames, job->output) == (size_t)frames;
+        pthread_mutex_lock(&job->mutex);
+        job->write_failed |= !ok;
+        job->next_written++;
+        pthread_cond_broadcast(&job->written);
+        pthread_mutex_unlock(&job->mutex);
+    }
+    return NULL;
+}
+
+/** @return The number of processors, to start as many workers */
+int video_processor_count()
+{
+#ifdef _WIN32
+    const char *count = getenv("NUMBER_OF_PROCESSORS");
+    return count != NULL && atoi(count) > 0 ? atoi(count) : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? count : 1;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s <trace file> <output file, or - for stdout> [seconds] [width] [height] [fps] [threads]\n", argv[0]);
+        return 1;
+    }
+    static VideoJob job;
+    if (!Trace_open(&job.trace, argv[1]))
+    {
+        fprintf(stderr, "Render: could not open trace %s\n", argv[1]);
+        return 1;
+    }
+    const char *path = argv[2];
+    double seconds = argc > 3 ? atof(argv[3]) : 60.0;
+    job.width = argc > 4 ? atoi(argv[4]) : 1280;
+    job.height = argc > 5 ? atoi(argv[5]) : 720;
+    job.fps = argc > 6 ? atoi(argv[6]) : 30;
+    int thread_count = argc > 7 ? atoi(argv[7]) : video_processor_count();
+    if (seconds <= 0.0 || job.width < 1 || job.height < 1 || job.fps < 1 || thread_count < 1 || job.trace.header.array_len == 0)
+    {
+        fprintf(stderr, "Render: invalid settings\n");
+        return 1;
+    }
+
+    job.frame_count = (int)(seconds * job.fps) + 1; // the last frame shows the end of the run
+    job.speed = job.trace.header.duration_ns / seconds;
+    if (job.speed <= 0.0)
+        job.speed = 1.0;
+    HeatPalette_init(&job.palette, COLOR_SUSTAIN);
+    int cold_step = 0;
+    while (cold_step < HEAT_DECAY_STEPS && job.palette.decay[cold_step] != 0)
+        cold_step++;
+    job.lookback = cold_step / HEAT_DECAY_STEPS_PER_SECOND;
+    size_t path_len = strlen(path);
+    job.y4m = path_len >= 4 && strcmp(path + path_len - 4, ".y4m") == 0;
+    size_t pixel_count = (size_t)job.width * job.height;
+    job.frame_size = job.y4m ? 6 + 3 * pixel_count : (size_t)snprintf(NULL, 0, "P6\n%d %d\n255\n", job.width, job.height) + 3 * pixel_count;
+
+    if (strcmp(path, "-") == 0)
+    {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        job.output = stdout;
+    }
+    else
+        job.output = fopen(path, "wb");
+    if (job.output == NULL)
+    {
+        fprintf(stderr, "Render: could not open %s\n", path);
+        return 1;
+    }
+    if (job.y4m)
+        fprintf(job.output, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", job.width, job.height, job.fps);
+
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.written, NULL);
+    size_t len = job.trace.header.array_len;
+    VideoWorker *workers = MemAlloc(thread_count * sizeof(VideoWorker));
+    uint64_t start = pacing_now();
+    for (int i = 0; i < thread_count; i++)
+    {
+        VideoWorker *worker = &workers[i];
+        *worker = (VideoWorker){&job};
+        worker->array = Array_new(len);
+        TraceReplay_init(&worker->replay, &job.trace, worker->array);
+        worker->reads = MemAlloc(len * sizeof(float));
+        worker->writes = MemAlloc(len * sizeof(float));
+        worker->frames = MemAlloc(VIDEO_FRAMES_PER_BATCH * job.frame_size);
+        BarCanvas_resize(&worker->canvas, job.width, job.height);
+        pthread_create(&worker->thread, NULL, video_worker_proc, worker);
+    }
+    for (int i = 0; i < thread_count; i++)
+    {
+        VideoWorker *worker = &workers[i];
+        pthread_join(worker->thread, NULL);
+        Array_free(worker->array);
+        MemFree(worker->reads);
+        MemFree(worker->writes);
+        MemFree(worker->frames);
+        ColumnSummary_free(&worker->summary);
+        HeatBuffers_free(&worker->heat);
+        BarCanvas_free(&worker->canvas);
+    }
+    double elapsed = (pacing_now() - start) * 1e-9;
+    MemFree(workers);
+    bool ok = !job.write_failed && (job.output == stdout ? fflush(stdout) == 0 : fclose(job.output) == 0);
+    Trace_close(&job.trace);
+    pthread_mutex_destroy(&job.mutex);
+    pthread_cond_destroy(&job.written);
+    if (!ok)
+    {
+        fprintf(stderr, "Render: could not write %s\n", path);
+        return 1;
+    }
+    fprintf(stderr, "%s: %d frames of %dx%d in %.2fs (%.1f frames per second, %d threads)\n",
+            path, job.frame_count, job.width, job.height, elapsed, job.frame_count / elapsed, thread_count);
+    return 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Defines a lock-free single-producer/single-consumer ring buffer type called `name` holding up to `capacity` items of type `type`,
+ * along with the functions `name##_push`, `name##_pop` and `name##_peek`.
+ * Exactly one thread may push and exactly one (other) thread may pop or peek; neither of them ever blocks.
+ * @param capacity The number of items the ring can hold; must be a power of two
+ * @note `head` and `tail` are kept on separate cache lines so that the producer and the consumer don't invalidate each other's line on every access.
+ */
+#define SPSC_RING_DEFINE(name, type, capacity)                                                  \
+    typedef struct name                                                                         \
+    {                                                                                           \
+        /** Index of the next item to pop; only written by the consumer */                      \
+        _Alignas(64) atomic_size_t head;                                                        \
+        /** Index of the next item to push; only written by the producer */                     \
+        _Alignas(64) atomic_size_t tail;                                                        \
+        _Alignas(64) type items[capacity];                                                      \
+    } name;                                                                                     \
+                                                                                                \
+    /** @return `false` if the ring is full, in which case `item` was not pushed */             \
+    static inline bool name##_push(name *ring, type item)                                       \
+    {                                                                                           \
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);                  \
+        if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == (capacity))       \
+            return false;                                                                       \
+        ring->items[tail & ((capacity) - 1)] = item;                                            \
+        atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);                     \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /** @return `false` if the ring is empty, in which case `*item` was not written */          \
+    static inline bool name##_peek(name *ring, type *item)                                      \
+    {                                                                                           \
+        size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);                  \
+        if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))                    \
+            return false;                                                                       \
+        *item = ring->items[head & ((capacity) - 1)];                                           \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /** @return `false` if the ring is empty, in which case `*item` was not written */          \
+    static inline bool name##_pop(name *ring, type *item)                                       \
+    {                                                                                           \
+        if (!name##_peek(ring, item))                                                           \
+            return false;                                                                       \
+        size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);                  \
+        atomic_store_explicit(&ring->head, head + 1, memory_order_release);                     \
+        return true;                                                                            \
+    }
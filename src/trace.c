@@ -0,0 +1,561 @@
+#pragma once
+
+#include "raylib.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "Array.c"
+#include "pacing.c"
+
+/*
+ * Binary access traces: every read and write an algorithm makes on an `Array`, recorded once at full speed so it can be replayed later.
+ *
+ * Layout of a trace file (all integers little-endian):
+ *   TraceHeader                 at offset 0, rewritten with the final counts when the recording ends
+ *   chunks                      one after the other, each a TraceChunkHeader followed by `payload_size` bytes
+ *   TraceIndexEntry[chunks]     at `index_offset`: a copy of the header of every chunk (without the payload size) and its file offset, in order
+ *
+ * The index and the chunk headers are fixed-size and every chunk decodes on its own, so a reader can `mmap` the file,
+ * binary search the index and start decoding at any chunk without reading what comes before it.
+ *
+ * Snapshot chunks hold the `array_len` values of the array (as `uint32_t`) before event `first_event`. One is recorded when the recording starts,
+ * then one (a keyframe) at least every `keyframe_interval` events, so that reaching any event takes one snapshot and a bounded number of events.
+ * Event chunks hold `event_count` events, grouped in records of one or more accesses of the same kind to consecutive items, each encoded as:
+ *   varint                 `zigzag(index delta) << 3 | is_run << 2 | has_time << 1 | kind`, where the index delta is the difference from the index of the last event
+ *                          of the previous record (from 0 for the first record of the chunk) and `kind` is the `TraceEventKind`
+ *   varint                 only if `is_run`: the number of events of the record minus 1, otherwise the record is one event
+ *   varint                 only if `has_time`: the time in nanoseconds since the previous record (since `first_time_ns` for the first record of the chunk);
+ *                          every event of the record has that time
+ *   varint[events]         only for writes: the value written by each event
+ * Reads store no value, since it is whatever the array holds when the read is replayed. Records never span two chunks.
+ * The clock is only sampled at the start of a record, at most once every `TRACE_CLOCK_INTERVAL` events, to keep recording cheap;
+ * the records in between share its time and store none.
+ * The scans sorts are made of become a single record, and neighbouring accesses make small index deltas, so most reads take a fraction of a byte
+ * and most writes 2 to 4 bytes.
+ */
+
+#define TRACE_MAGIC "SORTTRC1"
+#define TRACE_VERSION 2
+
+/** Chunks are closed after this many events */
+#define TRACE_EVENTS_PER_CHUNK 65536
+/** The clock is read at most once every this many events */
+#define TRACE_CLOCK_INTERVAL 64
+/** Keyframes are at least this many events apart, and at least `TRACE_KEYFRAME_EVENTS_PER_ITEM` times the array length, to keep them a small part of the file */
+#define TRACE_KEYFRAME_MIN_EVENTS (1 << 20)
+#define TRACE_KEYFRAME_EVENTS_PER_ITEM 4
+/** The most an encoded record can take per event: three 10-byte varints, for a record of one event */
+#define TRACE_MAX_EVENT_SIZE 30
+/** The number of chunk buffers shared by the recorder and its writer thread */
+#define TRACE_WRITE_BUFFERS 4
+/** The size of the `FILE` buffer of the writer thread */
+#define TRACE_FILE_BUFFER_SIZE (1 << 22)
+
+typedef enum TraceEventKind
+{
+    TRACE_READ,
+    TRACE_WRITE
+} TraceEventKind;
+
+typedef enum TraceChunkKind
+{
+    TRACE_CHUNK_SNAPSHOT,
+    TRACE_CHUNK_EVENTS
+} TraceChunkKind;
+
+typedef struct TraceHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    /** The number of items of the recorded array */
+    uint64_t array_len;
+    /** The total number of events */
+    uint64_t event_count;
+    /** The time of the last event, in nanoseconds since the recording started */
+    uint64_t duration_ns;
+    /** The file offset of the chunk index */
+    uint64_t index_offset;
+    /** The number of chunks (and of entries in the index) */
+    uint64_t chunk_count;
+    /** The most events there can be between two snapshots */
+    uint64_t keyframe_interval;
+} TraceHeader;
+
+typedef struct TraceChunkHeader
+{
+    /** A `TraceChunkKind` */
+    uint32_t kind;
+    /** The number of events in the chunk (0 for snapshots) */
+    uint32_t event_count;
+    /** The number of events recorded before this chunk */
+    uint64_t first_event;
+    /** The number of those events that were reads */
+    uint64_t read_count;
+    /** The time of the last event before this chunk (0 if none), in nanoseconds since the recording started; the events of the chunk are no earlier */
+    uint64_t first_time_ns;
+    uint64_t payload_size;
+} TraceChunkHeader;
+
+typedef struct TraceIndexEntry
+{
+    uint32_t kind;
+    uint32_t event_count;
+    uint64_t first_event;
+    uint64_t read_count;
+    uint64_t first_time_ns;
+    /** The file offset of the chunk's `TraceChunkHeader` */
+    uint64_t offset;
+} TraceIndexEntry;
+
+/** @brief Writes `value` as a LEB128 varint at `out` and returns the position after it */
+static inline unsigned char *trace_put_varint(unsigned char *out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = (unsigned char)value | 0x80;
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+    return out;
+}
+
+/**
+ * @brief Reads a LEB128 varint at `*in` (which ends before `end`) into `*value` and advances `*in` past it
+ * @return `false` if the varint runs past `end` or past 64 bits, with `*in` left anywhere up to `end`
+ */
+static inline bool trace_get_varint(const unsigned char **in, const unsigned char *end, uint64_t *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64 && *in < end; shift += 7)
+    {
+        unsigned char byte = *(*in)++;
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static inline uint64_t trace_zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t trace_unzigzag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/** A chunk on its way to the file: its header followed by its payload */
+typedef struct TraceBuffer
+{
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+} TraceBuffer;
+
+/**
+ * Records the accesses made on one `Array` to a trace file.
+ * The sort thread encodes events into a chunk buffer; full chunks are handed to a writer thread so the sort never waits for the disk
+ * (unless the disk falls `TRACE_WRITE_BUFFERS` chunks behind).
+ */
+typedef struct TraceRecorder
+{
+    FILE *file;
+    /** The recorded `Array` */
+    Array array;
+    uint64_t start_ns;
+    uint64_t event_count;
+    uint64_t read_count;
+    uint64_t time_ns;
+    uint64_t file_offset;
+    /** A snapshot is recorded at the first chunk boundary `keyframe_interval` events or more after the last one, at event `keyframe_event` */
+    uint64_t keyframe_interval;
+    uint64_t keyframe_event;
+
+    /** The chunk being encoded, and what its next record is relative to */
+    TraceBuffer *chunk;
+    uint32_t chunk_events;
+    uint64_t chunk_first_event;
+    uint64_t chunk_read_count;
+    uint64_t chunk_first_time_ns;
+    size_t previous_index;
+    uint64_t previous_time_ns;
+    /** The clock is read again at the first record starting at or after this event */
+    uint64_t clock_event;
+
+    /** The run of reads not encoded yet: the items from `run_first` to before `run_next`, in order (none if they are equal).
+     * A read of `run_next` extends it while `run_room` (the room left for it in the chunk) isn't 0 */
+    size_t run_first;
+    size_t run_next;
+    uint32_t run_room;
+    bool run_has_time;
+
+    TraceIndexEntry *index;
+    size_t index_count;
+    size_t index_capacity;
+
+    /** Buffers are either free (in `free_buffers`), being encoded (`chunk`), or waiting for the writer (in `full_buffers`, oldest first) */
+    TraceBuffer buffers[TRACE_WRITE_BUFFERS];
+    TraceBuffer *free_buffers[TRACE_WRITE_BUFFERS];
+    int free_count;
+    TraceBuffer *full_buffers[TRACE_WRITE_BUFFERS];
+    int full_count;
+    bool closing;
+    bool write_failed;
+    pthread_t writer;
+    pthread_mutex_t mutex;
+    pthread_cond_t buffer_freed;
+    pthread_cond_t buffer_filled;
+} TraceRecorder;
+
+/** @brief The writer thread: writes full chunks to the file in order until the recorder closes */
+static void *_TraceRecorder_writer(void *args)
+{
+    TraceRecorder *recorder = args;
+    pthread_mutex_lock(&recorder->mutex);
+    while (true)
+    {
+        while (recorder->full_count == 0 && !recorder->closing)
+            pthread_cond_wait(&recorder->buffer_filled, &recorder->mutex);
+        if (recorder->full_count == 0)
+            break;
+        TraceBuffer *buffer = recorder->full_buffers[0];
+        pthread_mutex_unlock(&recorder->mutex);
+        bool ok = fwrite(buffer->data, 1, buffer->size, recorder->file) == buffer->size;
+        pthread_mutex_lock(&recorder->mutex);
+        if (!ok)
+            recorder->write_failed = true;
+        recorder->full_count--;
+        memmove(recorder->full_buffers, recorder->full_buffers + 1, recorder->full_count * sizeof(TraceBuffer *));
+        buffer->size = 0;
+        recorder->free_buffers[recorder->free_count++] = buffer;
+        pthread_cond_signal(&recorder->buffer_freed);
+    }
+    pthread_mutex_unlock(&recorder->mutex);
+    return NULL;
+}
+
+/** @brief Takes a free buffer with room for `size` bytes, waiting for the writer thread if there is none */
+static TraceBuffer *_TraceRecorder_take_buffer(TraceRecorder *recorder, size_t size)
+{
+    pthread_mutex_lock(&recorder->mutex);
+    while (recorder->free_count == 0)
+        pthread_cond_wait(&recorder->buffer_freed, &recorder->mutex);
+    TraceBuffer *buffer = recorder->free_buffers[--recorder->free_count];
+    pthread_mutex_unlock(&recorder->mutex);
+    if (buffer->capacity < size)
+    {
+        buffer->data = MemRealloc(buffer->data, size);
+        buffer->capacity = size;
+    }
+    buffer->size = 0;
+    return buffer;
+}
+
+/** @brief Adds `buffer` (a complete chunk) to the index and hands it to the writer thread */
+static void _TraceRecorder_submit(TraceRecorder *recorder, TraceBuffer *buffer)
+{
+    TraceChunkHeader header;
+    memcpy(&header, buffer->data, sizeof(header));
+    if (recorder->index_count == recorder->index_capacity)
+    {
+        recorder->index_capacity = recorder->index_capacity * 2 + 64;
+        recorder->index = MemRealloc(recorder->index, recorder->index_capacity * sizeof(TraceIndexEntry));
+    }
+    recorder->index[recorder->index_count++] = (TraceIndexEntry){header.kind, header.event_count, header.first_event, header.read_count, header.first_time_ns, recorder->file_offset};
+    recorder->file_offset += buffer->size;
+
+    pthread_mutex_lock(&recorder->mutex);
+    recorder->full_buffers[recorder->full_count++] = buffer;
+    pthread_cond_signal(&recorder->buffer_filled);
+    pthread_mutex_unlock(&recorder->mutex);
+}
+
+/** @brief Closes the chunk being encoded (if it has any events) and submits it */
+static void _TraceRecorder_flush_chunk(TraceRecorder *recorder)
+{
+    if (recorder->chunk == NULL)
+        return;
+    if (recorder->chunk_events == 0)
+    {
+        pthread_mutex_lock(&recorder->mutex);
+        recorder->free_buffers[recorder->free_count++] = recorder->chunk;
+        pthread_cond_signal(&recorder->buffer_freed);
+        pthread_mutex_unlock(&recorder->mutex);
+        recorder->chunk = NULL;
+        return;
+    }
+    TraceChunkHeader header = {TRACE_CHUNK_EVENTS, recorder->chunk_events, recorder->chunk_first_event, recorder->chunk_read_count,
+                               recorder->chunk_first_time_ns, recorder->chunk->size - sizeof(TraceChunkHeader)};
+    memcpy(recorder->chunk->data, &header, sizeof(header));
+    _TraceRecorder_submit(recorder, recorder->chunk);
+    recorder->chunk = NULL;
+}
+
+static void _TraceRecorder_end_run(TraceRecorder *recorder);
+
+/** @brief Records a snapshot of the whole recorded array as it is now */
+void TraceRecorder_snapshot(TraceRecorder *recorder)
+{
+    _TraceRecorder_end_run(recorder);
+    _TraceRecorder_flush_chunk(recorder);
+    size_t payload_size = recorder->array->len * sizeof(uint32_t);
+    TraceBuffer *buffer = _TraceRecorder_take_buffer(recorder, sizeof(TraceChunkHeader) + payload_size);
+    TraceChunkHeader header = {TRACE_CHUNK_SNAPSHOT, 0, recorder->event_count, recorder->read_count, recorder->time_ns, payload_size};
+    memcpy(buffer->data, &header, sizeof(header));
+    for (size_t i = 0; i < recorder->array->len; i++)
+    {
+        uint32_t value = recorder->array->_arr[i];
+        memcpy(buffer->data + sizeof(header) + i * sizeof(uint32_t), &value, sizeof(uint32_t));
+    }
+    buffer->size = sizeof(header) + payload_size;
+    _TraceRecorder_submit(recorder, buffer);
+    recorder->keyframe_event = recorder->event_count;
+}
+
+/**
+ * @brief Starts recording the accesses made on `array` to the file at `path`, beginning with a snapshot of its current contents
+ * @return `false` if the file couldn't be opened, or its header couldn't be written
+ * @note Accesses only reach the recorder through `TraceRecorder_record` and `TraceRecorder_record_range`, see `TraceRecorder_observer`
+ */
+bool TraceRecorder_open(TraceRecorder *recorder, const char *path, Array array)
+{
+    *recorder = (TraceRecorder){0};
+    recorder->file = fopen(path, "wb");
+    if (recorder->file == NULL)
+        return false;
+    setvbuf(recorder->file, NULL, _IOFBF, TRACE_FILE_BUFFER_SIZE);
+    recorder->array = array;
+    recorder->start_ns = pacing_now();
+    recorder->keyframe_interval = array->len * TRACE_KEYFRAME_EVENTS_PER_ITEM > TRACE_KEYFRAME_MIN_EVENTS ? array->len * TRACE_KEYFRAME_EVENTS_PER_ITEM : TRACE_KEYFRAME_MIN_EVENTS;
+    TraceHeader header = {TRACE_MAGIC, TRACE_VERSION, sizeof(TraceHeader), array->len};
+    if (fwrite(&header, sizeof(header), 1, recorder->file) != 1)
+    {
+        fclose(recorder->file);
+        *recorder = (TraceRecorder){0};
+        return false;
+    }
+    recorder->file_offset = sizeof(header);
+
+    for (int i = 0; i < TRACE_WRITE_BUFFERS; i++)
+        recorder->free_buffers[recorder->free_count++] = &recorder->buffers[i];
+    pthread_mutex_init(&recorder->mutex, NULL);
+    pthread_cond_init(&recorder->buffer_freed, NULL);
+    pthread_cond_init(&recorder->buffer_filled, NULL);
+    pthread_create(&recorder->writer, NULL, _TraceRecorder_writer, recorder);
+    TraceRecorder_snapshot(recorder);
+    return true;
+}
+
+/** @brief Internal function: encodes a record of the `count` accesses of `kind` to the items from `index` (and the values written, for writes)
+ * into the chunk, which has room for them, with the time `recorder->time_ns` if `has_time`; submits the chunk once it is full */
+static void _TraceRecorder_encode(TraceRecorder *recorder, TraceEventKind kind, size_t index, uint32_t count, const unsigned int *values, bool has_time)
+{
+    unsigned char *out = recorder->chunk->data + recorder->chunk->size;
+    out = trace_put_varint(out, trace_zigzag((int64_t)index - (int64_t)recorder->previous_index) << 3 | (uint64_t)(count > 1) << 2 | (uint64_t)has_time << 1 | kind);
+    if (count > 1)
+        out = trace_put_varint(out, count - 1);
+    if (has_time)
+    {
+        out = trace_put_varint(out, recorder->time_ns - recorder->previous_time_ns);
+        recorder->previous_time_ns = recorder->time_ns;
+    }
+    if (kind == TRACE_WRITE)
+        for (uint32_t i = 0; i < count; i++)
+            out = trace_put_varint(out, values[i]);
+    recorder->chunk->size = out - recorder->chunk->data;
+    recorder->previous_index = index + count - 1;
+    recorder->event_count += count;
+    recorder->read_count += kind == TRACE_READ ? count : 0;
+    recorder->chunk_events += count;
+    if (recorder->chunk_events == TRACE_EVENTS_PER_CHUNK)
+    {
+        _TraceRecorder_flush_chunk(recorder);
+        if (recorder->event_count - recorder->keyframe_event >= recorder->keyframe_interval)
+            TraceRecorder_snapshot(recorder);
+    }
+}
+
+/** @brief Internal function: encodes the pending run of reads, if there is one */
+static void _TraceRecorder_end_run(TraceRecorder *recorder)
+{
+    size_t first = recorder->run_first, count = recorder->run_next - first;
+    // cleared first, since encoding may take a snapshot, which ends the run too
+    recorder->run_first = recorder->run_next;
+    recorder->run_room = 0;
+    if (count > 0)
+        _TraceRecorder_encode(recorder, TRACE_READ, first, (uint32_t)count, NULL, recorder->run_has_time);
+}
+
+/**
+ * @brief Internal function: prepares a record starting at the next event: takes a chunk if there is none, and reads the clock if it is due
+ * @return Whether the record has a time
+ */
+static bool _TraceRecorder_start_record(TraceRecorder *recorder)
+{
+    if (recorder->chunk == NULL)
+    {
+        recorder->chunk = _TraceRecorder_take_buffer(recorder, sizeof(TraceChunkHeader) + TRACE_EVENTS_PER_CHUNK * TRACE_MAX_EVENT_SIZE);
+        recorder->chunk->size = sizeof(TraceChunkHeader);
+        recorder->chunk_events = 0;
+        recorder->chunk_first_event = recorder->event_count;
+        recorder->chunk_read_count = recorder->read_count;
+        recorder->chunk_first_time_ns = recorder->time_ns;
+        recorder->previous_index = 0;
+        recorder->previous_time_ns = recorder->time_ns;
+    }
+    if (recorder->event_count < recorder->clock_event)
+        return false;
+    recorder->time_ns = pacing_now() - recorder->start_ns;
+    recorder->clock_event = recorder->event_count + TRACE_CLOCK_INTERVAL;
+    return true;
+}
+
+/** @brief Internal function: whether a read of item `index` just extends the pending run of reads, which it then does */
+static inline bool _TraceRecorder_extend_run(TraceRecorder *recorder, size_t index)
+{
+    if (index != recorder->run_next || recorder->run_room == 0)
+        return false;
+    recorder->run_next++;
+    recorder->run_room--;
+    return true;
+}
+
+/** @brief Records one access to item `index` of the recorded array; `value` is the value written (ignored for reads) */
+void TraceRecorder_record(TraceRecorder *recorder, TraceEventKind kind, size_t index, unsigned int value)
+{
+    if (kind == TRACE_READ && _TraceRecorder_extend_run(recorder, index))
+        return;
+    _TraceRecorder_end_run(recorder);
+    bool has_time = _TraceRecorder_start_record(recorder);
+    if (kind == TRACE_WRITE)
+    {
+        _TraceRecorder_encode(recorder, TRACE_WRITE, index, 1, &value, has_time);
+        return;
+    }
+    // a read starts a run, encoded once the next access doesn't extend it
+    recorder->run_first = index;
+    recorder->run_next = index + 1;
+    recorder->run_room = TRACE_EVENTS_PER_CHUNK - recorder->chunk_events - 1;
+    recorder->run_has_time = has_time;
+}
+
+/** @brief Records accesses to the `count` items of the recorded array from `index`, in order; the values written are taken from the array */
+void TraceRecorder_record_range(TraceRecorder *recorder, TraceEventKind kind, size_t index, size_t count)
+{
+    if (kind == TRACE_READ)
+    {
+        while (count > 0)
+        {
+            if (index == recorder->run_next && recorder->run_room != 0)
+            {
+                uint32_t extended = count < recorder->run_room ? (uint32_t)count : recorder->run_room;
+                recorder->run_next += extended;
+                recorder->run_room -= extended;
+                index += extended;
+                count -= extended;
+            }
+            else
+            {
+                TraceRecorder_record(recorder, TRACE_READ, index, 0);
+                index++;
+                count--;
+            }
+        }
+        return;
+    }
+    _TraceRecorder_end_run(recorder);
+    while (count > 0)
+    {
+        bool has_time = _TraceRecorder_start_record(recorder);
+        uint32_t room = TRACE_EVENTS_PER_CHUNK - recorder->chunk_events;
+        uint32_t written = count < room ? (uint32_t)count : room;
+        _TraceRecorder_encode(recorder, TRACE_WRITE, index, written, recorder->array->_arr + index, has_time);
+        index += written;
+        count -= written;
+    }
+}
+
+/** @return The number of accesses recorded so far, including those not encoded yet */
+static inline uint64_t TraceRecorder_event_count(const TraceRecorder *recorder)
+{
+    return recorder->event_count + (recorder->run_next - recorder->run_first);
+}
+
+/**
+ * @brief Writes the last chunk, the index and the final header, then closes the file
+ * @return `false` if anything failed to be written
+ */
+bool TraceRecorder_close(TraceRecorder *recorder)
+{
+    _TraceRecorder_end_run(recorder);
+    _TraceRecorder_flush_chunk(recorder);
+    pthread_mutex_lock(&recorder->mutex);
+    recorder->closing = true;
+    pthread_cond_signal(&recorder->buffer_filled);
+    pthread_mutex_unlock(&recorder->mutex);
+    pthread_join(recorder->writer, NULL);
+
+    bool ok = !recorder->write_failed;
+    ok &= fwrite(recorder->index, sizeof(TraceIndexEntry), recorder->index_count, recorder->file) == recorder->index_count;
+    TraceHeader header = {TRACE_MAGIC, TRACE_VERSION, sizeof(TraceHeader), recorder->array->len,
+                          recorder->event_count, recorder->time_ns, recorder->file_offset, recorder->index_count,
+                          recorder->keyframe_interval + TRACE_EVENTS_PER_CHUNK - 1};
+    ok &= fseek(recorder->file, 0, SEEK_SET) == 0;
+    ok &= fwrite(&header, sizeof(header), 1, recorder->file) == 1;
+    ok &= fclose(recorder->file) == 0;
+
+    for (int i = 0; i < TRACE_WRITE_BUFFERS; i++)
+        MemFree(recorder->buffers[i].data);
+    MemFree(recorder->index);
+    pthread_mutex_destroy(&recorder->mutex);
+    pthread_cond_destroy(&recorder->buffer_freed);
+    pthread_cond_destroy(&recorder->buffer_filled);
+    return ok;
+}
+
+/** An `Array_CallbackType` recording reads of the array of the `TraceRecorder` `context`
+ * @note The reads of a scan only extend the pending run here; nothing is encoded until the scan ends */
+void trace_read_callback(void *context, Array array, size_t index)
+{
+    TraceRecorder *recorder = context;
+    if (array == recorder->array && !_TraceRecorder_extend_run(recorder, index))
+        TraceRecorder_record(recorder, TRACE_READ, index, 0);
+}
+
+/** An `Array_CallbackType` recording writes to the array of the `TraceRecorder` `context` */
+void trace_write_callback(void *context, Array array, size_t index)
+{
+    TraceRecorder *recorder = context;
+    if (array == recorder->array)
+        TraceRecorder_record(recorder, TRACE_WRITE, index, array->_arr[index]);
+}
+
+/** An `Array_RangeCallbackType` recording reads of a range of the array of the `TraceRecorder` `context` */
+void trace_read_range_callback(void *context, Array array, size_t index, size_t count)
+{
+    TraceRecorder *recorder = context;
+    if (array == recorder->array)
+        TraceRecorder_record_range(recorder, TRACE_READ, index, count);
+}
+
+/** An `Array_RangeCallbackType` recording writes to a range of the array of the `TraceRecorder` `context` */
+void trace_write_range_callback(void *context, Array array, size_t index, size_t count)
+{
+    TraceRecorder *recorder = context;
+    if (array == recorder->array)
+        TraceRecorder_record_range(recorder, TRACE_WRITE, index, count);
+}
+
+/**
+ * @return An observer recording the accesses of the array of `recorder` to it, to attach to that array with `Array_observe`;
+ * range operations are recorded as one record each
+ * @note Accesses to scratch arrays that share the observer (see `Array_new_scratch`) aren't recorded, since a trace holds a single array
+ */
+Array_Observer TraceRecorder_observer(TraceRecorder *recorder)
+{
+    return (Array_Observer){trace_read_callback, trace_write_callback, NULL, recorder, trace_read_range_callback, trace_write_range_callback};
+}
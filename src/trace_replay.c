@@ -0,0 +1,342 @@
+#pragma once
+
+#include "raylib.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "Array.c"
+#include "trace.c"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Playback of the access traces written by `TraceRecorder` (see `trace.c`).
+ * The file is memory-mapped (read whole on Windows) and decoded in place; jumping to any event loads the last keyframe before it
+ * (found by binary search in the chunk index) and replays at most `keyframe_interval` events from there.
+ */
+
+/** An opened trace file */
+typedef struct Trace
+{
+    TraceHeader header;
+    /** The whole file */
+    const unsigned char *data;
+    size_t size;
+    /** A copy of the chunk index (`header.chunk_count` entries) */
+    TraceIndexEntry *index;
+    /** The positions in `index` of the snapshot chunks, in order */
+    size_t *keyframes;
+    size_t keyframe_count;
+} Trace;
+
+/** One decoded event of a trace */
+typedef struct TraceEvent
+{
+    TraceEventKind kind;
+    size_t index;
+    /** The value written, or read (reads only get theirs when they are played, see `TraceReplay_step`) */
+    unsigned int value;
+    /** In nanoseconds since the recording started */
+    uint64_t time_ns;
+} TraceEvent;
+
+/**
+ * @brief Decodes the event after `*event` (or, before the first one of a chunk, index 0 and the first time of the chunk) into `*event`,
+ * advancing `*cursor` (in a chunk payload ending before `end`) past what it takes.
+ * `*run_left` is the number of events of the current record after `*event`; 0 at the start of a chunk
+ * @return `false` if the record runs past `end` or doesn't fit below `array_len`
+ */
+static bool _Trace_decode_event(const unsigned char **cursor, const unsigned char *end, uint64_t array_len, TraceEvent *event, uint64_t *run_left)
+{
+    uint64_t value = 0;
+    if (*run_left > 0)
+    {
+        // the next event of the record: the whole record was checked to fit in the array when it started
+        (*run_left)--;
+        event->index++;
+        if (event->kind == TRACE_WRITE && !trace_get_varint(cursor, end, &value))
+            return false;
+        event->value = value;
+        return true;
+    }
+    uint64_t head, count = 0, time_delta = 0;
+    if (!trace_get_varint(cursor, end, &head) || ((head & 4) && !trace_get_varint(cursor, end, &count)) ||
+        ((head & 2) && !trace_get_varint(cursor, end, &time_delta)) || ((head & 1) == TRACE_WRITE && !trace_get_varint(cursor, end, &value)))
+        return false;
+    event->kind = head & 1;
+    event->index += trace_unzigzag(head >> 3);
+    event->value = value;
+    event->time_ns += time_delta;
+    *run_left = count;
+    return event->index < array_len && count < array_len - event->index;
+}
+
+/** @brief Frees what `Trace_open` mapped and allocated, leaving `trace` empty */
+void Trace_close(Trace *trace)
+{
+    if (trace->data != NULL)
+#ifdef _WIN32
+        MemFree((void *)trace->data);
+#else
+        munmap((void *)trace->data, trace->size);
+#endif
+    MemFree(trace->index);
+    MemFree(trace->keyframes);
+    *trace = (Trace){0};
+}
+
+/**
+ * @brief Opens the trace file at `path` and checks that its header, index and chunk headers are consistent,
+ * and that every event fits in its chunk and in the array, so that playing the trace can't go out of bounds. Decodes every event once.
+ * @return `false` (with `trace` left empty) if the file can't be read or isn't a complete trace
+ */
+bool Trace_open(Trace *trace, const char *path)
+{
+    *trace = (Trace){0};
+#ifdef _WIN32
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *data = size > 0 ? MemAlloc(size) : NULL;
+    bool read = data != NULL && fread(data, 1, size, file) == (size_t)size;
+    fclose(file);
+    if (!read)
+    {
+        MemFree(data);
+        return false;
+    }
+    trace->data = data;
+    trace->size = size;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat status;
+    void *data = fstat(fd, &status) == 0 && status.st_size > 0 ? mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    trace->data = data;
+    trace->size = status.st_size;
+#endif
+
+    TraceHeader *header = &trace->header;
+    bool valid = trace->size >= sizeof(TraceHeader);
+    if (valid)
+        memcpy(header, trace->data, sizeof(TraceHeader));
+    valid = valid && memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) == 0 && header->version == TRACE_VERSION &&
+            header->header_size == sizeof(TraceHeader) && header->chunk_count > 0 &&
+            header->index_offset <= trace->size && (trace->size - header->index_offset) / sizeof(TraceIndexEntry) >= header->chunk_count;
+    if (valid)
+    {
+        trace->index = MemAlloc(header->chunk_count * sizeof(TraceIndexEntry));
+        trace->keyframes = MemAlloc(header->chunk_count * sizeof(size_t));
+        memcpy(trace->index, trace->data + header->index_offset, header->chunk_count * sizeof(TraceIndexEntry));
+        valid = trace->index[0].kind == TRACE_CHUNK_SNAPSHOT && trace->index[0].first_event == 0;
+    }
+    uint64_t event = 0;
+    for (size_t c = 0; valid && c < header->chunk_count; c++)
+    {
+        const TraceIndexEntry *entry = &trace->index[c];
+        TraceChunkHeader chunk;
+        valid = entry->offset <= header->index_offset && header->index_offset - entry->offset >= sizeof(chunk) && entry->first_event == event;
+        if (!valid)
+            break;
+        memcpy(&chunk, trace->data + entry->offset, sizeof(chunk));
+        valid = chunk.kind == entry->kind && chunk.first_event == entry->first_event &&
+                chunk.payload_size <= header->index_offset - entry->offset - sizeof(chunk) &&
+                (chunk.kind == TRACE_CHUNK_EVENTS || (chunk.kind == TRACE_CHUNK_SNAPSHOT && chunk.payload_size == header->array_len * sizeof(uint32_t)));
+        valid = valid && chunk.event_count == entry->event_count;
+        if (valid && chunk.kind == TRACE_CHUNK_EVENTS)
+        {
+            const unsigned char *cursor = trace->data + entry->offset + sizeof(chunk);
+            const unsigned char *end = cursor + chunk.payload_size;
+            TraceEvent decoded = {.time_ns = entry->first_time_ns};
+            uint64_t run_left = 0;
+            for (uint32_t e = 0; valid && e < chunk.event_count; e++)
+                valid = _Trace_decode_event(&cursor, end, header->array_len, &decoded, &run_left);
+            // the last record ends with the chunk
+            valid = valid && run_left == 0;
+        }
+        if (valid && chunk.kind == TRACE_CHUNK_SNAPSHOT)
+            trace->keyframes[trace->keyframe_count++] = c;
+        event += chunk.event_count;
+    }
+    if (!valid || event != header->event_count)
+    {
+        Trace_close(trace);
+        return false;
+    }
+    return true;
+}
+
+/** @return The position in `trace->index` of the last snapshot chunk at or before event `event`. O(log chunks). */
+size_t Trace_keyframe_before(const Trace *trace, uint64_t event)
+{
+    size_t low = 0, high = trace->keyframe_count; // the answer is in [low, high)
+    while (high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (trace->index[trace->keyframes[middle]].first_event <= event)
+            low = middle;
+        else
+            high = middle;
+    }
+    return trace->keyframes[low];
+}
+
+/** @return The position in `trace->index` of the last chunk starting no later than `time_ns`, or 0. O(log chunks). */
+size_t Trace_chunk_before_time(const Trace *trace, uint64_t time_ns)
+{
+    size_t low = 0, high = trace->header.chunk_count;
+    while (high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (trace->index[middle].first_time_ns <= time_ns)
+            low = middle;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * The state of an `Array` at some point of a trace, moved through by stepping forward or seeking anywhere.
+ * The values are written straight to the array's items, without going through the `Array` functions, so no callback sees them.
+ */
+typedef struct TraceReplay
+{
+    const Trace *trace;
+    /** The array the trace is played on; it has `trace->header.array_len` items */
+    Array array;
+    /** The number of events applied to `array` */
+    uint64_t position;
+    /** The number of those that were reads */
+    uint64_t read_count;
+    /** The time of the last event applied (or of the keyframe the replay started from) */
+    uint64_t time_ns;
+
+    /** The event after `position`, already decoded (if `position` isn't the end) */
+    TraceEvent next;
+    /** The decoder: the chunk `next` is from, where the event after it starts, how many events of the chunk remain after it */
+    size_t chunk;
+    const unsigned char *cursor;
+    /** The end of the payload of the chunk `cursor` is in */
+    const unsigned char *end;
+    uint32_t chunk_left;
+    /** The number of events of the record of `next` after it */
+    uint64_t run_left;
+} TraceReplay;
+
+/**
+ * @brief Decodes the event after `replay->next` into `replay->next`, moving to the next event chunk if needed
+ * @note `Trace_open` checked every event, so this can't fail
+ */
+static void _TraceReplay_decode(TraceReplay *replay)
+{
+    const Trace *trace = replay->trace;
+    if (replay->chunk_left == 0)
+    {
+        do
+            replay->chunk++;
+        while (replay->chunk < trace->header.chunk_count && trace->index[replay->chunk].kind != TRACE_CHUNK_EVENTS);
+        if (replay->chunk >= trace->header.chunk_count)
+            return;
+        const TraceIndexEntry *entry = &trace->index[replay->chunk];
+        TraceChunkHeader chunk;
+        memcpy(&chunk, trace->data + entry->offset, sizeof(chunk));
+        replay->cursor = trace->data + entry->offset + sizeof(chunk);
+        replay->end = replay->cursor + chunk.payload_size;
+        replay->chunk_left = entry->event_count;
+        replay->run_left = 0;
+        replay->next.index = 0;
+        replay->next.time_ns = entry->first_time_ns;
+    }
+    _Trace_decode_event(&replay->cursor, replay->end, trace->header.array_len, &replay->next, &replay->run_left);
+    replay->chunk_left--;
+}
+
+/** @brief Loads the snapshot chunk at `chunk` of the index into the array */
+static void _TraceReplay_load_keyframe(TraceReplay *replay, size_t chunk)
+{
+    const Trace *trace = replay->trace;
+    const TraceIndexEntry *entry = &trace->index[chunk];
+    memcpy(replay->array->_arr, trace->data + entry->offset + sizeof(TraceChunkHeader), trace->header.array_len * sizeof(uint32_t));
+    replay->position = entry->first_event;
+    replay->read_count = entry->read_count;
+    replay->time_ns = entry->first_time_ns;
+    replay->chunk = chunk;
+    replay->chunk_left = 0;
+    if (replay->position < trace->header.event_count)
+        _TraceReplay_decode(replay);
+}
+
+/** @return Whether there are events after `replay->position` */
+static inline bool TraceReplay_has_next(const TraceReplay *replay)
+{
+    return replay->position < replay->trace->header.event_count;
+}
+
+/**
+ * @brief Applies the next event of the trace to the array
+ * @return `false` if the trace is over; otherwise `true`, with the event in `*event` if `event` isn't `NULL`
+ */
+bool TraceReplay_step(TraceReplay *replay, TraceEvent *event)
+{
+    if (!TraceReplay_has_next(replay))
+        return false;
+    TraceEvent next = replay->next;
+    if (next.kind == TRACE_WRITE)
+        replay->array->_arr[next.index] = next.value;
+    else
+        next.value = replay->array->_arr[next.index]; // reads aren't recorded with their value: it is the one in the array
+    replay->read_count += next.kind == TRACE_READ;
+    replay->time_ns = next.time_ns;
+    replay->position++;
+    if (event != NULL)
+        *event = next;
+    if (TraceReplay_has_next(replay))
+        _TraceReplay_decode(replay);
+    return true;
+}
+
+/**
+ * @brief Brings the array to its state after `event` events of the trace (or to the end of the trace if there are fewer)
+ * @note Costs one snapshot load and at most `keyframe_interval` event replays; seeking forward past fewer events than that just steps
+ */
+void TraceReplay_seek(TraceReplay *replay, uint64_t event)
+{
+    const Trace *trace = replay->trace;
+    if (event > trace->header.event_count)
+        event = trace->header.event_count;
+    size_t keyframe = Trace_keyframe_before(trace, event);
+    if (event < replay->position || trace->index[keyframe].first_event > replay->position)
+        _TraceReplay_load_keyframe(replay, keyframe);
+    while (replay->position < event)
+        TraceReplay_step(replay, NULL);
+}
+
+/** @brief Brings the array to its state after the last event that happened at or before `time_ns` */
+void TraceReplay_seek_time(TraceReplay *replay, uint64_t time_ns)
+{
+    const Trace *trace = replay->trace;
+    // the events of a chunk are no later than the first time of the next one, so all the events before this chunk happened by `time_ns`
+    TraceReplay_seek(replay, trace->index[Trace_chunk_before_time(trace, time_ns)].first_event);
+    while (TraceReplay_has_next(replay) && replay->next.time_ns <= time_ns)
+        TraceReplay_step(replay, NULL);
+}
+
+/** @brief Starts playing `trace` on `array` (which must have `trace->header.array_len` items) from its first event */
+void TraceReplay_init(TraceReplay *replay, const Trace *trace, Array array)
+{
+    *replay = (TraceReplay){trace, array};
+    _TraceReplay_load_keyframe(replay, 0);
+}